@@ -0,0 +1,159 @@
+//===-- Benchmark.cpp -----------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+using namespace klee::benchmark;
+
+namespace {
+
+struct Entry {
+  std::string name;
+  Function function;
+  std::vector<int64_t> ranges;
+};
+
+std::vector<Entry> &getRegistry() {
+  static std::vector<Entry> registry;
+  return registry;
+}
+
+struct Result {
+  std::string name;
+  uint64_t iterations;
+  double seconds;
+};
+
+bool startsWith(const std::string &s, const std::string &prefix) {
+  return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+void printJSON(llvm::raw_ostream &os, const std::vector<Result> &results) {
+  char date[64];
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+
+  os << "{\n";
+  os << "  \"context\": {\n";
+  os << "    \"date\": \"" << date << "\",\n";
+#ifdef NDEBUG
+  os << "    \"library_build_type\": \"release\"\n";
+#else
+  os << "    \"library_build_type\": \"debug\"\n";
+#endif
+  os << "  },\n";
+  os << "  \"benchmarks\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &r = results[i];
+    double ns = r.seconds * 1e9 / r.iterations;
+    os << "    {\n";
+    os << "      \"name\": \"" << r.name << "\",\n";
+    os << "      \"iterations\": " << r.iterations << ",\n";
+    os << "      \"real_time\": " << ns << ",\n";
+    os << "      \"cpu_time\": " << ns << ",\n";
+    os << "      \"time_unit\": \"ns\"\n";
+    os << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  os << "  ]\n";
+  os << "}\n";
+}
+
+void printConsole(llvm::raw_ostream &os, const std::vector<Result> &results) {
+  for (const Result &r : results) {
+    os << r.name << ": " << (r.seconds * 1e9 / r.iterations) << " ns ("
+       << r.iterations << " iterations)\n";
+  }
+}
+
+} // namespace
+
+Registration::Registration(const char *name, Function function,
+                           const Arguments &arguments) {
+  if (arguments.empty()) {
+    getRegistry().push_back(Entry{name, function, std::vector<int64_t>()});
+    return;
+  }
+
+  for (const std::vector<int64_t> &ranges : arguments) {
+    std::string fullName = name;
+    for (int64_t r : ranges)
+      fullName += "/" + std::to_string(r);
+    getRegistry().push_back(Entry{fullName, function, ranges});
+  }
+}
+
+int klee::benchmark::runBenchmarks(int argc, char **argv) {
+  std::string filter, format = "console", out;
+  double minTime = 0.5;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (startsWith(arg, "--benchmark_filter=")) {
+      filter = arg.substr(19);
+    } else if (startsWith(arg, "--benchmark_min_time=")) {
+      minTime = atof(arg.substr(21).c_str());
+    } else if (startsWith(arg, "--benchmark_format=")) {
+      format = arg.substr(19);
+    } else if (startsWith(arg, "--benchmark_out=")) {
+      out = arg.substr(16);
+    } else {
+      llvm::errs() << "unknown option: " << arg << "\n";
+      return 1;
+    }
+  }
+
+  std::vector<Result> results;
+  for (const Entry &e : getRegistry()) {
+    if (!filter.empty() && e.name.find(filter) == std::string::npos)
+      continue;
+
+    // Grow the number of iterations until the run is long enough to be
+    // measured reliably.
+    uint64_t iterations = 1;
+    while (true) {
+      State state(iterations, e.ranges);
+      e.function(state);
+      double seconds = state.getElapsedSeconds();
+      if (seconds >= minTime || iterations >= (uint64_t)1 << 40) {
+        results.push_back(Result{e.name, iterations, seconds});
+        break;
+      }
+      iterations *= 10;
+    }
+  }
+
+  if (out.empty()) {
+    if (format == "json")
+      printJSON(llvm::outs(), results);
+    else
+      printConsole(llvm::outs(), results);
+    return 0;
+  }
+
+  std::error_code ec;
+  llvm::raw_fd_ostream os(out, ec, llvm::sys::fs::F_None);
+  if (ec) {
+    llvm::errs() << "cannot open " << out << ": " << ec.message() << "\n";
+    return 1;
+  }
+  printJSON(os, results);
+  printConsole(llvm::outs(), results);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  return klee::benchmark::runBenchmarks(argc, argv);
+}
@@ -0,0 +1,108 @@
+//===-- Benchmark.h ---------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A small harness for microbenchmarks. Benchmarks are registered with
+// KLEE_BENCHMARK and time the body of a `while (state.keepRunning())` loop.
+// KLEE_BENCHMARK_ARGS runs a benchmark once per argument list, reported as
+// "name/arg0/arg1/..." and read back with state.range(i). The output follows the JSON format of Google Benchmark, so results can be
+// compared across commits with its tools.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_BENCHMARK_H
+#define KLEE_BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace klee {
+namespace benchmark {
+
+class State {
+  typedef std::chrono::steady_clock clock;
+
+  uint64_t iterations;
+  uint64_t remaining;
+  bool started;
+  clock::time_point start;
+  clock::duration elapsed;
+  std::vector<int64_t> ranges;
+
+public:
+  explicit State(uint64_t iterations,
+                 const std::vector<int64_t> &ranges = std::vector<int64_t>())
+      : iterations(iterations), remaining(iterations), started(false),
+        elapsed(clock::duration::zero()), ranges(ranges) {}
+
+  /// The i-th argument given with KLEE_BENCHMARK_ARGS.
+  int64_t range(size_t i) const { return ranges[i]; }
+
+  /// Returns true while there are iterations left to run.
+  bool keepRunning() {
+    if (!started) {
+      started = true;
+      start = clock::now();
+    }
+    if (remaining == 0) {
+      pauseTiming();
+      return false;
+    }
+    --remaining;
+    return true;
+  }
+
+  /// Excludes the following code (e.g. setup) from the measurement.
+  void pauseTiming() {
+    elapsed += clock::now() - start;
+  }
+
+  void resumeTiming() {
+    start = clock::now();
+  }
+
+  uint64_t getIterations() const { return iterations; }
+
+  double getElapsedSeconds() const {
+    return std::chrono::duration<double>(elapsed).count();
+  }
+};
+
+typedef void (*Function)(State &);
+
+typedef std::vector<std::vector<int64_t>> Arguments;
+
+struct Registration {
+  Registration(const char *name, Function function,
+               const Arguments &arguments = Arguments());
+};
+
+/// Runs the registered benchmarks, returns the exit code.
+/// Options: --benchmark_filter=<substring> --benchmark_min_time=<seconds>
+///          --benchmark_format=<console|json> --benchmark_out=<file>
+int runBenchmarks(int argc, char **argv);
+
+/// Prevents the compiler from optimizing away a computed value.
+template <class T> inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace benchmark
+} // namespace klee
+
+#define KLEE_BENCHMARK(function)                                               \
+  static ::klee::benchmark::Registration function##Registration(#function,     \
+                                                                function)
+
+#define KLEE_BENCHMARK_ARGS(function, ...)                                     \
+  static ::klee::benchmark::Registration function##Registration(               \
+      #function, function, ::klee::benchmark::Arguments{__VA_ARGS__})
+
+#endif /* KLEE_BENCHMARK_H */
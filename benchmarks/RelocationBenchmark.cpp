@@ -0,0 +1,419 @@
+//===-- RelocationBenchmark.cpp -------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The hot paths of the relocatable addressing engine (--use-sym-addr) on a
+// synthetic state: N objects with symbolic addresses, each holding a
+// pointer to the next one and a symbolic byte, and M constraints over the
+// addresses and the contents. The arguments are reported in the benchmark
+// names (e.g. Unfold/256/256), so results stay comparable across commits.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+
+#include "Core/AddressSpace.h"
+#include "Core/Context.h"
+#include "Core/Executor.h"
+#include "Core/Memory.h"
+#include "Core/MemoryManager.h"
+#include "Core/TimingSolver.h"
+
+#include "klee/ExecutionState.h"
+#include "klee/Internal/Module/InstructionInfoTable.h"
+#include "klee/Internal/Module/KModule.h"
+#include "klee/Interpreter.h"
+#include "klee/Solver.h"
+#include "klee/SolverImpl.h"
+
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <memory>
+#include <unistd.h>
+#include <vector>
+
+using namespace klee;
+using namespace klee::benchmark;
+
+namespace {
+
+/// The relocation code reports every rebased object with klee_message,
+/// which always goes to stderr. Keep the console readable while the
+/// messages are still being formatted and written.
+class SilenceStderr {
+  int saved;
+
+public:
+  SilenceStderr() {
+    fflush(stderr);
+    saved = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDERR_FILENO);
+    close(null);
+  }
+
+  ~SilenceStderr() {
+    fflush(stderr);
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+  }
+};
+
+class NullHandler : public InterpreterHandler {
+public:
+  llvm::raw_ostream &getInfoStream() const { return llvm::nulls(); }
+  std::string getOutputFilename(const std::string &filename) {
+    return "/dev/null";
+  }
+  std::unique_ptr<llvm::raw_fd_ostream>
+  openOutputFile(const std::string &filename) {
+    return nullptr;
+  }
+  void incPathsExplored() {}
+  void processTestCase(const ExecutionState &state, const char *err,
+                       const char *suffix) {}
+};
+
+/// Answers every query without looking at it: nothing must be true and
+/// every value is the given address, so a resolution visits all objects.
+class StubSolverImpl : public SolverImpl {
+  uint64_t value;
+
+public:
+  explicit StubSolverImpl(uint64_t value) : value(value) {}
+
+  bool computeTruth(const Query &query, bool &isValid) {
+    isValid = false;
+    return true;
+  }
+
+  bool computeValue(const Query &query, ref<Expr> &result) {
+    result = ConstantExpr::create(value, query.expr->getWidth());
+    return true;
+  }
+
+  bool computeInitialValues(const Query &query,
+                            const std::vector<const Array *> &objects,
+                            std::vector<std::vector<unsigned char>> &values,
+                            bool &hasSolution) {
+    hasSolution = false;
+    return true;
+  }
+
+  SolverRunStatus getOperationStatusCode() {
+    return SOLVER_RUN_STATUS_SUCCESS_SOLVABLE;
+  }
+};
+
+void initialize() {
+  static bool initialized = false;
+  if (!initialized) {
+    const char *argv[] = {"RelocationBenchmark", "--use-sym-addr",
+                          "--solver-backend=dummy"};
+    llvm::cl::ParseCommandLineOptions(3, argv);
+    Context::initialize(true, Expr::Int64);
+    initialized = true;
+  }
+}
+
+} // namespace
+
+namespace klee {
+
+/// Builds the synthetic state through the executor, the same way
+/// executeAlloc and executeMemoryOperation do.
+class RelocationFixture {
+public:
+  static const unsigned ObjectSize = 64;
+
+  llvm::LLVMContext ctx;
+  std::unique_ptr<llvm::Module> module;
+  KModule kmodule;
+  std::unique_ptr<KFunction> kf;
+  NullHandler handler;
+  std::unique_ptr<Executor> executor;
+  ExecutionState *state;
+
+  const Array *input;
+  std::vector<ObjectPair> objects;
+  /* the update list of each object, after the symbolic writes */
+  std::vector<UpdateList> updates;
+
+  RelocationFixture(unsigned numObjects, unsigned numConstraints)
+      : state(nullptr) {
+    initialize();
+
+    module.reset(new llvm::Module("benchmark", ctx));
+    llvm::Function *f = llvm::Function::Create(
+        llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), false),
+        llvm::Function::ExternalLinkage, "benchmark", module.get());
+    llvm::ReturnInst::Create(ctx, llvm::BasicBlock::Create(ctx, "entry", f));
+    kf.reset(new KFunction(f, &kmodule));
+
+    executor.reset(new Executor(ctx, Interpreter::InterpreterOptions(),
+                                &handler));
+    state = new ExecutionState(kf.get(), executor->memory);
+    input = executor->arrayCache.CreateArray("input", 256);
+
+    for (unsigned i = 0; i < numObjects; i++)
+      objects.push_back(allocate(ObjectSize));
+
+    for (unsigned i = 0; i < numObjects; i++) {
+      ObjectState *os = writeable(objects[i]);
+      os->write(0, objects[(i + 1) % numObjects].first->getBaseExpr());
+      os->write(8, byte(i));
+      /* a symbolic read flushes the writes into the update list */
+      ref<Expr> value = os->read(ZExtExpr::create(byte(i), Expr::Int32),
+                                 Expr::Int8);
+      updates.push_back(cast<ReadExpr>(value)->updates);
+    }
+
+    for (unsigned j = 0; j < numConstraints; j++) {
+      const ObjectPair &op = objects[j % numObjects];
+      ref<Expr> offset = ZExtExpr::create(byte(j), Expr::Int64);
+      if (j % 2 == 0) {
+        ref<Expr> base = op.first->getBaseExpr();
+        state->addConstraint(UltExpr::create(
+            AddExpr::create(base, offset),
+            AddExpr::create(base, ConstantExpr::create(ObjectSize,
+                                                       Expr::Int64))));
+      } else {
+        ref<Expr> value = op.second->read(offset, Expr::Int8);
+        state->addConstraint(NeExpr::create(value, byte(j + 1)));
+      }
+    }
+
+    SilenceStderr silence;
+    state->computeRewrittenConstraints();
+  }
+
+  ~RelocationFixture() { delete state; }
+
+  ref<Expr> byte(unsigned i) const {
+    return ReadExpr::create(UpdateList(input, nullptr),
+                            ConstantExpr::create(i % input->size, Expr::Int32));
+  }
+
+  ObjectPair allocate(unsigned size) {
+    MemoryObject *mo = executor->memory->allocate(size, false, false, nullptr,
+                                                  8, &state->localSpace);
+    ObjectState *os = executor->bindObjectInState(*state, mo, false);
+    os->initializeToZero();
+    SymbolicAddressInfo info;
+    executor->symbolizeMO(*state, mo, info);
+    os->addSubObject(0, size, info);
+    return ObjectPair(mo, os);
+  }
+
+  ObjectState *writeable(const ObjectPair &op) {
+    return state->addressSpace.getWriteable(op.first, op.second);
+  }
+
+  /// The objects as bound in a copy of the state.
+  static void bound(const ExecutionState &es,
+                    const std::vector<ObjectPair> &objects,
+                    std::vector<ObjectPair> &result) {
+    for (const ObjectPair &op : objects)
+      result.push_back(ObjectPair(op.first,
+                                  es.addressSpace.findObject(op.first)));
+  }
+
+  void fillSegment(ExecutionState &es, const MemoryObject *segmentMO,
+                   ObjectState *segmentOS, std::vector<ObjectPair> &ops,
+                   std::vector<unsigned> &offsets) {
+    executor->fillSegment(es, segmentMO, segmentOS, ops, offsets, false);
+  }
+
+  ObjectState *allocateSegment(ExecutionState &es, unsigned size,
+                               const MemoryObject *&segmentMO) {
+    MemoryObject *mo = executor->memory->allocate(size, false, false, nullptr,
+                                                  8, &es.localSpace);
+    ObjectState *os = executor->bindObjectInState(es, mo, false);
+    os->initializeToZero();
+    SymbolicAddressInfo info;
+    executor->symbolizeMO(es, mo, info);
+    os->addSubSegment(0, size, info);
+    segmentMO = mo;
+    return os;
+  }
+
+  bool splitMO(ExecutionState &es, ObjectPair op) {
+    return executor->splitMO(es, op);
+  }
+};
+
+} // namespace klee
+
+namespace {
+
+/// Substituting the address arrays in all the path constraints.
+void Unfold(State &state) {
+  RelocationFixture f(state.range(0), state.range(1));
+
+  while (state.keepRunning()) {
+    for (ref<Expr> e : f.state->constraints)
+      doNotOptimize(f.state->unfold(e));
+  }
+}
+KLEE_BENCHMARK_ARGS(Unfold, {16, 16}, {256, 256}, {256, 4096});
+
+/// Rebuilding the rewritten constraints, done after every rebase and split.
+void ComputeRewrittenConstraints(State &state) {
+  RelocationFixture f(state.range(0), state.range(1));
+  SilenceStderr silence;
+
+  while (state.keepRunning()) {
+    f.state->computeRewrittenConstraints();
+  }
+}
+KLEE_BENCHMARK_ARGS(ComputeRewrittenConstraints, {16, 16}, {256, 256},
+                    {256, 4096});
+
+/// Rewriting the update list of every object onto its cached array.
+void RewriteUL(State &state) {
+  RelocationFixture f(state.range(0), 0);
+  std::vector<const Array *> rewritten;
+  {
+    SilenceStderr silence;
+    for (const UpdateList &ul : f.updates)
+      rewritten.push_back(f.state->rewriteUL(ul, nullptr).root);
+  }
+
+  while (state.keepRunning()) {
+    for (unsigned i = 0; i < f.updates.size(); i++)
+      doNotOptimize(f.state->rewriteUL(f.updates[i], rewritten[i]).root);
+  }
+}
+KLEE_BENCHMARK_ARGS(RewriteUL, {16}, {256});
+
+/// Looking up the rewritten arrays through a history of rebases, each of
+/// eight objects.
+void RebaseCacheFind(State &state) {
+  static const std::string file = "benchmark";
+  static const InstructionInfo info(0, file, 0, 0, 0);
+  const unsigned GroupSize = 8;
+
+  RelocationFixture f(state.range(0), 0);
+  RebaseCache cache;
+  for (unsigned i = 0; i < f.objects.size(); i += GroupSize) {
+    Arrays arrays;
+    for (unsigned k = i; k < i + GroupSize && k < f.objects.size(); k++)
+      arrays.push_back(f.objects[k].first->sainfo.arrayID);
+    RebaseID rid = RebaseID::create(&info,
+                                    GroupSize * RelocationFixture::ObjectSize,
+                                    arrays, std::vector<uint64_t>(),
+                                    std::vector<AllocationContext>());
+    cache.add(RebaseInfo(rid, f.objects[i].first,
+                         ObjectHolder(f.writeable(f.objects[i]))));
+    f.state->addRebaseID(rid);
+  }
+
+  std::vector<ObjectState *> states;
+  for (const ObjectPair &op : f.objects)
+    states.push_back(f.writeable(op));
+  {
+    /* the first lookup of each object creates its array */
+    SilenceStderr silence;
+    for (unsigned i = 0; i < states.size(); i++)
+      cache.find(*f.state, states[i], f.updates[i]);
+  }
+
+  while (state.keepRunning()) {
+    for (unsigned i = 0; i < states.size(); i++)
+      doNotOptimize(cache.find(*f.state, states[i], f.updates[i]).root);
+  }
+}
+KLEE_BENCHMARK_ARGS(RebaseCacheFind, {16}, {256});
+
+/// A symbolic pointer into the middle object, resolved against a solver
+/// that admits every object.
+void Resolve(State &state) {
+  RelocationFixture f(state.range(0), state.range(1));
+  const ObjectPair &middle = f.objects[f.objects.size() / 2];
+  TimingSolver solver(new Solver(new StubSolverImpl(middle.first->address)));
+  ref<Expr> p = AddExpr::create(middle.first->getBaseExpr(),
+                                ZExtExpr::create(f.byte(0), Expr::Int64));
+  std::vector<AllocationContext> contexts;
+
+  while (state.keepRunning()) {
+    ResolutionList rl;
+    f.state->addressSpace.resolve(*f.state, &solver, p, rl, contexts);
+    doNotOptimize(rl.size());
+  }
+}
+KLEE_BENCHMARK_ARGS(Resolve, {16, 16}, {256, 256});
+
+/// Copying all the objects into a fresh segment and moving their addresses.
+void FillSegment(State &state) {
+  RelocationFixture f(state.range(0), state.range(1));
+  SilenceStderr silence;
+
+  while (state.keepRunning()) {
+    state.pauseTiming();
+    ExecutionState *es = new ExecutionState(*f.state);
+    std::vector<ObjectPair> ops;
+    RelocationFixture::bound(*es, f.objects, ops);
+    std::vector<unsigned> offsets;
+    for (unsigned i = 0; i < ops.size(); i++)
+      offsets.push_back(i * RelocationFixture::ObjectSize);
+    const MemoryObject *segmentMO;
+    ObjectState *segmentOS = f.allocateSegment(
+        *es, ops.size() * RelocationFixture::ObjectSize, segmentMO);
+    state.resumeTiming();
+
+    f.fillSegment(*es, segmentMO, segmentOS, ops, offsets);
+
+    state.pauseTiming();
+    delete es;
+    state.resumeTiming();
+  }
+}
+KLEE_BENCHMARK_ARGS(FillSegment, {16, 16}, {256, 256});
+
+/// Splitting an object of the given size into partitions, including the
+/// rewrite of the constraints that follows.
+void SplitMO(State &state) {
+  RelocationFixture f(state.range(0), state.range(1));
+  ObjectPair large = f.allocate(state.range(2));
+  SilenceStderr silence;
+
+  while (state.keepRunning()) {
+    state.pauseTiming();
+    ExecutionState *es = new ExecutionState(*f.state);
+    ObjectPair op(large.first, es->addressSpace.findObject(large.first));
+    state.resumeTiming();
+
+    f.splitMO(*es, op);
+
+    state.pauseTiming();
+    delete es;
+    state.resumeTiming();
+  }
+}
+KLEE_BENCHMARK_ARGS(SplitMO, {16, 16, 1024}, {256, 256, 16384});
+
+/// Forking a state: the copy and its destruction.
+void StateCopy(State &state) {
+  RelocationFixture f(state.range(0), state.range(1));
+
+  while (state.keepRunning()) {
+    delete new ExecutionState(*f.state);
+  }
+}
+KLEE_BENCHMARK_ARGS(StateCopy, {16, 16}, {256, 256});
+
+} // namespace
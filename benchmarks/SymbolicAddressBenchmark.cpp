@@ -0,0 +1,165 @@
+//===-- SymbolicAddressBenchmark.cpp --------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Throughput of symbolic address allocation (--use-sym-addr): creating the
+// addr_N arrays and their pointer values, and registering them in a state
+// through the executor.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+
+#include "Core/AddressArrayPool.h"
+#include "Core/Context.h"
+#include "Core/Executor.h"
+#include "Core/Memory.h"
+
+#include "klee/ExecutionState.h"
+#include "klee/Internal/Module/InstructionInfoTable.h"
+#include "klee/Internal/Module/KModule.h"
+#include "klee/Interpreter.h"
+#include "klee/util/ArrayCache.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <memory>
+
+using namespace klee;
+using namespace klee::benchmark;
+
+namespace {
+
+void initializeContext() {
+  static bool initialized = false;
+  if (!initialized) {
+    const char *argv[] = {"SymbolicAddressBenchmark", "--use-sym-addr",
+                          "--solver-backend=dummy"};
+    llvm::cl::ParseCommandLineOptions(3, argv);
+    Context::initialize(true, Expr::Int64);
+    initialized = true;
+  }
+}
+
+class NullHandler : public InterpreterHandler {
+public:
+  llvm::raw_ostream &getInfoStream() const { return llvm::nulls(); }
+  std::string getOutputFilename(const std::string &filename) {
+    return "/dev/null";
+  }
+  std::unique_ptr<llvm::raw_fd_ostream>
+  openOutputFile(const std::string &filename) {
+    return nullptr;
+  }
+  void incPathsExplored() {}
+  void processTestCase(const ExecutionState &state, const char *err,
+                       const char *suffix) {}
+};
+
+} // namespace
+
+namespace klee {
+
+/// An executor and an empty state to register addresses in.
+class SymbolicAddressFixture {
+public:
+  llvm::LLVMContext ctx;
+  std::unique_ptr<llvm::Module> module;
+  KModule kmodule;
+  std::unique_ptr<KFunction> kf;
+  NullHandler handler;
+  std::unique_ptr<Executor> executor;
+  ExecutionState *state;
+
+  SymbolicAddressFixture() : state(nullptr) {
+    initializeContext();
+
+    module.reset(new llvm::Module("benchmark", ctx));
+    llvm::Function *f = llvm::Function::Create(
+        llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), false),
+        llvm::Function::ExternalLinkage, "benchmark", module.get());
+    llvm::ReturnInst::Create(ctx, llvm::BasicBlock::Create(ctx, "entry", f));
+    kf.reset(new KFunction(f, &kmodule));
+
+    executor.reset(new Executor(ctx, Interpreter::InterpreterOptions(),
+                                &handler));
+    state = new ExecutionState(kf.get(), executor->memory);
+  }
+
+  ~SymbolicAddressFixture() { delete state; }
+
+  void symbolizeAddress(uint64_t address, SymbolicAddressInfo &info) {
+    executor->symbolizeAddress(*state, address, info);
+  }
+};
+
+} // namespace klee
+
+namespace {
+
+/// The allocation path used before the pool: format a name, look it up in
+/// the array cache and build the pointer value on first use.
+void AddressArrayByName(State &state) {
+  initializeContext();
+  ArrayCache cache;
+  std::map<uint64_t, ref<Expr>> expressions;
+  uint64_t n = 0;
+
+  while (state.keepRunning()) {
+    const Array *array = cache.CreateArray("addr_" + llvm::utostr(n++), 8);
+    auto i = expressions.find(array->id);
+    if (i == expressions.end()) {
+      ref<Expr> kids[8];
+      for (unsigned k = 0; k < 8; k++) {
+        kids[k] = ReadExpr::create(UpdateList(array, nullptr),
+                                   ConstantExpr::create(8 - k - 1, Expr::Int32));
+      }
+      expressions[array->id] = ConcatExpr::createN(8, kids);
+    }
+  }
+}
+KLEE_BENCHMARK(AddressArrayByName);
+
+/// Address arrays taken from the pool, including the chunked growth.
+void AddressArrayPoolGet(State &state) {
+  initializeContext();
+  ArrayCache cache;
+  AddressArrayPool pool(&cache);
+  uint64_t n = 0;
+
+  while (state.keepRunning()) {
+    doNotOptimize(pool.get(n++).array);
+  }
+}
+KLEE_BENCHMARK(AddressArrayPoolGet);
+
+/// Executor::symbolizeAddress: a fresh address array for the state and its
+/// address constraint.
+void SymbolizeAddress(State &state) {
+  SymbolicAddressFixture f;
+  uint64_t address = 0x10000;
+
+  while (state.keepRunning()) {
+    SymbolicAddressInfo info;
+    f.symbolizeAddress(address, info);
+    doNotOptimize(info.arrayID);
+    address += 16;
+  }
+}
+KLEE_BENCHMARK(SymbolizeAddress);
+
+} // namespace
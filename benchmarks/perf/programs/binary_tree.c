@@ -0,0 +1,70 @@
+// Insertion into an unbalanced binary search tree and a lookup of a
+// symbolic key. The shape of the tree, and so the pointer chains, depends
+// on the order of the keys.
+#include "klee/klee.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define N 5
+
+struct node {
+  int key;
+  struct node *left;
+  struct node *right;
+};
+
+static struct node *insert(struct node *root, int key) {
+  struct node **p = &root;
+  while (*p)
+    p = key < (*p)->key ? &(*p)->left : &(*p)->right;
+
+  struct node *n = malloc(sizeof(*n));
+  n->key = key;
+  n->left = n->right = NULL;
+  *p = n;
+  return root;
+}
+
+static int contains(struct node *root, int key) {
+  while (root) {
+    if (root->key == key)
+      return 1;
+    root = key < root->key ? root->left : root->right;
+  }
+  return 0;
+}
+
+static int height(struct node *root) {
+  if (!root)
+    return 0;
+  int l = height(root->left), r = height(root->right);
+  return 1 + (l > r ? l : r);
+}
+
+static void release(struct node *root) {
+  if (!root)
+    return;
+  release(root->left);
+  release(root->right);
+  free(root);
+}
+
+int main() {
+  int keys[N], key;
+  klee_make_symbolic(keys, sizeof(keys), "keys");
+  klee_make_symbolic(&key, sizeof(key), "key");
+
+  struct node *root = NULL;
+  for (int i = 0; i < N; i++)
+    root = insert(root, keys[i]);
+
+  assert(contains(root, keys[N - 1]));
+  assert(height(root) <= N);
+  if (contains(root, key))
+    klee_assume(key == keys[0] | key == keys[1] | key == keys[2] |
+                key == keys[3] | key == keys[4]);
+
+  release(root);
+  return 0;
+}
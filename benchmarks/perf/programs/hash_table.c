@@ -0,0 +1,72 @@
+// A chained hash table with symbolic keys. The bucket is selected by a
+// symbolic index into the array of chain heads, so every insertion and
+// lookup resolves a symbolic pointer.
+#include "klee/klee.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define BUCKETS 4
+#define N 4
+
+struct entry {
+  unsigned key;
+  unsigned value;
+  struct entry *next;
+};
+
+struct table {
+  struct entry *buckets[BUCKETS];
+  unsigned size;
+};
+
+static void put(struct table *t, unsigned key, unsigned value) {
+  struct entry **p = &t->buckets[key % BUCKETS];
+  for (; *p; p = &(*p)->next) {
+    if ((*p)->key == key) {
+      (*p)->value = value;
+      return;
+    }
+  }
+
+  struct entry *e = malloc(sizeof(*e));
+  e->key = key;
+  e->value = value;
+  e->next = NULL;
+  *p = e;
+  t->size++;
+}
+
+static struct entry *get(struct table *t, unsigned key) {
+  for (struct entry *e = t->buckets[key % BUCKETS]; e; e = e->next)
+    if (e->key == key)
+      return e;
+  return NULL;
+}
+
+int main() {
+  unsigned keys[N], key;
+  klee_make_symbolic(keys, sizeof(keys), "keys");
+  klee_make_symbolic(&key, sizeof(key), "key");
+
+  struct table *t = calloc(1, sizeof(*t));
+  for (unsigned i = 0; i < N; i++)
+    put(t, keys[i], i);
+
+  assert(t->size <= N);
+  assert(get(t, keys[0]) != NULL);
+  struct entry *e = get(t, key);
+  if (e)
+    assert(e->key == key);
+
+  for (unsigned b = 0; b < BUCKETS; b++) {
+    struct entry *e = t->buckets[b];
+    while (e) {
+      struct entry *next = e->next;
+      free(e);
+      e = next;
+    }
+  }
+  free(t);
+  return 0;
+}
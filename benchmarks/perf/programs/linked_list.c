@@ -0,0 +1,61 @@
+// Sorted insertion into a singly linked list, followed by the removal of a
+// symbolic key. Every node is a separate heap object reached through
+// symbolic pointers.
+#include "klee/klee.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define N 5
+
+struct node {
+  int key;
+  struct node *next;
+};
+
+static struct node *insert(struct node *head, int key) {
+  struct node *n = malloc(sizeof(*n));
+  n->key = key;
+
+  struct node **p = &head;
+  while (*p && (*p)->key < key)
+    p = &(*p)->next;
+  n->next = *p;
+  *p = n;
+  return head;
+}
+
+static struct node *removeKey(struct node *head, int key) {
+  struct node **p = &head;
+  while (*p) {
+    if ((*p)->key == key) {
+      struct node *n = *p;
+      *p = n->next;
+      free(n);
+      break;
+    }
+    p = &(*p)->next;
+  }
+  return head;
+}
+
+int main() {
+  int keys[N], removed;
+  klee_make_symbolic(keys, sizeof(keys), "keys");
+  klee_make_symbolic(&removed, sizeof(removed), "removed");
+
+  struct node *head = NULL;
+  for (int i = 0; i < N; i++)
+    head = insert(head, keys[i]);
+  head = removeKey(head, removed);
+
+  for (struct node *n = head; n && n->next; n = n->next)
+    assert(n->key <= n->next->key);
+
+  while (head) {
+    struct node *next = head->next;
+    free(head);
+    head = next;
+  }
+  return 0;
+}
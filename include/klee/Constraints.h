@@ -77,6 +77,11 @@ public:
   void clear() {
     constraints.clear();
   }
+
+  /// Exchange the constraints with other, without any optimization.
+  void swap(constraints_ty &other) {
+    constraints.swap(other);
+  }
   
   bool mayHaveAddressConstraints() const {
     for (ref<Expr> e : constraints) {
@@ -12,9 +12,13 @@
 
 #include "klee/Constraints.h"
 #include "klee/Expr.h"
+#include "klee/Internal/ADT/LRUCache.h"
+#include "klee/Internal/ADT/ParkedVector.h"
 #include "klee/Internal/ADT/TreeStream.h"
+#include "klee/Internal/Module/Cell.h"
 #include "klee/Internal/System/Time.h"
 #include "klee/MergeHandler.h"
+#include "klee/util/ArrayCache.h"
 #include "klee/util/ExprVisitor.h"
 
 // FIXME: We do not want to be exposing these? :(
@@ -26,6 +30,7 @@
 #include "llvm/Support/CommandLine.h"
 
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 #include <unordered_map>
@@ -44,16 +49,55 @@ extern llvm::cl::opt<bool> UseLocalSymAddr;
 extern llvm::cl::opt<unsigned> UseKContext;
 extern llvm::cl::opt<bool> UseGlobalID;
 extern llvm::cl::opt<bool> UseGlobalRewriteCache;
+extern llvm::cl::opt<unsigned> MaxRewriteCacheSize;
 
 llvm::raw_ostream &operator<<(llvm::raw_ostream &os, const MemoryMap &mm);
 
+/// The registers of a stack frame. Copies share the cells until one of
+/// them is written (copy on write), so forking a state only copies the
+/// frames that are written afterwards, which is usually just the active
+/// one. Released cells are kept in a pool and reused by the next frame of
+/// the same size instead of going back to the heap.
+class FrameLocals {
+  struct Block {
+    unsigned refCount;
+    unsigned size;
+    Cell *cells;
+  };
+
+  Block *block;
+
+  /// Released blocks by size, their cells are all null.
+  static std::vector<std::vector<Block *> > &getFreeBlocks();
+  static Block *allocate(unsigned size);
+  void release();
+  void unshare();
+
+public:
+  explicit FrameLocals(unsigned size) : block(allocate(size)) {}
+  FrameLocals(const FrameLocals &other) : block(other.block) {
+    ++block->refCount;
+  }
+  FrameLocals &operator=(const FrameLocals &other);
+  ~FrameLocals() { release(); }
+
+  const Cell &operator[](unsigned i) const { return block->cells[i]; }
+
+  /// Access a cell for writing, the cells are copied first if shared.
+  Cell &getMutable(unsigned i) {
+    if (block->refCount > 1)
+      unshare();
+    return block->cells[i];
+  }
+};
+
 struct StackFrame {
   KInstIterator caller;
   KFunction *kf;
   CallPathNode *callPathNode;
 
   std::vector<const MemoryObject *> allocas;
-  Cell *locals;
+  FrameLocals locals;
 
   /// Minimum distance to an uncovered instruction once the function
   /// returns. This is not a good place for this but is used to
@@ -70,8 +114,6 @@ struct StackFrame {
   MemoryObject *varargs;
 
   StackFrame(KInstIterator caller, KFunction *kf);
-  StackFrame(const StackFrame &s);
-  ~StackFrame();
 };
 
 struct AddressRecord {
@@ -86,37 +128,90 @@ struct AddressRecord {
 
 typedef std::vector<uint64_t> Arrays;
 
-struct RebaseID {
+/* the interned contents of a rebase identifier */
+struct RebaseIDData {
   const InstructionInfo *info;
   /* the size of the created segment */
   size_t size;
-  /* TODO: add docs */
-  Arrays arrays;
-  /* TODO: add docs */
+  /* the identifiers of the rebased arrays, in rebase order (interned) */
+  const Arrays *arrays;
+  /* the same identifiers sorted, for intersecting with other sets */
+  Arrays sortedArrays;
+  /* the addresses of the rebased objects (when first seen) */
   std::vector<uint64_t> addrs;
-  /* TODO: should be here? */
+  /* the allocation contexts of the rebased objects (when first seen) */
   std::vector<AllocationContext> acs;
+  /* computed once, when interned */
+  unsigned hash;
+};
+
+/* Identifies a rebase by its instruction, segment size and rebased arrays.
+   Identifiers are interned in a global table, so equality is a pointer
+   comparison and each history entry takes a single word. */
+class RebaseID {
+  const RebaseIDData *data;
+
+  explicit RebaseID(const RebaseIDData *data) : data(data) {
+
+  }
+
+public:
+
+  RebaseID() : data(nullptr) {
+
+  }
+
+  static RebaseID create(const InstructionInfo *info,
+                         size_t size,
+                         const Arrays &arrays,
+                         const std::vector<uint64_t> &addrs,
+                         const std::vector<AllocationContext> &acs);
+
+  /* frees the interned identifiers, no handle may be used afterwards */
+  static void clearTable();
+
+  bool isNull() const {
+    return data == nullptr;
+  }
+
+  const InstructionInfo *getInfo() const {
+    return data->info;
+  }
 
-  RebaseID() :
-    info(nullptr) {
+  size_t getSize() const {
+    return data->size;
+  }
 
+  const Arrays &getArrays() const {
+    return *data->arrays;
   }
 
-  RebaseID(const InstructionInfo *info,
-           size_t size,
-           Arrays &arrays,
-           std::vector<uint64_t> addrs,
-           std::vector<AllocationContext> acs) :
-    info(info), size(size), arrays(arrays), addrs(addrs), acs(acs) {
+  const Arrays &getSortedArrays() const {
+    return data->sortedArrays;
+  }
+
+  const std::vector<uint64_t> &getAddresses() const {
+    return data->addrs;
+  }
 
+  const std::vector<AllocationContext> &getContexts() const {
+    return data->acs;
   }
 
-  bool operator==(const RebaseID &other) {
-    return info == other.info && arrays == other.arrays && size == other.size;
+  unsigned hash() const {
+    return data->hash;
   }
 
-  bool operator!=(const RebaseID &other) {
-    return !(this->operator==(other));
+  bool operator==(const RebaseID &other) const {
+    return data == other.data;
+  }
+
+  bool operator!=(const RebaseID &other) const {
+    return data != other.data;
+  }
+
+  bool operator<(const RebaseID &other) const {
+    return data < other.data;
   }
 
   void dump() const;
@@ -126,14 +221,17 @@ struct RebaseInfo {
   RebaseID rid;
   const MemoryObject *mo;
   ObjectHolder oh;
-  std::map<uint64_t, const Array *> arrays;
+  /* the offsets of the rebased objects in the segment, in rebase order */
+  std::vector<unsigned> offsets;
+  /* object address -> rewritten array (bounded) */
+  LRUCache<uint64_t, ArrayHolder> arrays;
 
-  RebaseInfo() : mo(nullptr) {
+  RebaseInfo() : mo(nullptr), arrays(MaxRewriteCacheSize) {
 
   }
 
-  RebaseInfo(RebaseID &rid, const MemoryObject *mo, ObjectHolder oh) :
-    rid(rid), mo(mo), oh(oh) {
+  RebaseInfo(const RebaseID &rid, const MemoryObject *mo, ObjectHolder oh) :
+    rid(rid), mo(mo), oh(oh), arrays(MaxRewriteCacheSize) {
 
   }
 };
@@ -142,7 +240,7 @@ class RebaseCache {
 
 public:
 
-  RebaseCache(): refCount(0) {
+  RebaseCache(): refCount(0), unrebased(MaxRewriteCacheSize) {
 
   }
 
@@ -153,15 +251,34 @@ public:
     return instance;
   }
 
+  /* frees the cache and the interned rebase identifiers */
+  static void destroy();
+
   UpdateList find(const ExecutionState &state, ObjectState *os, const UpdateList &ul);
 
+  /* returns null if the rebase was not seen yet */
+  RebaseInfo *lookup(const RebaseID &rid);
+
+  void add(const RebaseInfo &info);
+
   unsigned int refCount;
   std::vector<RebaseInfo> rebased;
-  std::map<uint64_t, const Array *> unrebased;
+  /* rebase identifier -> index in rebased */
+  std::map<RebaseID, size_t> index;
+  /* object address -> rewritten array (bounded) */
+  LRUCache<uint64_t, ArrayHolder> unrebased;
 
   static RebaseCache *instance;
 };
 
+/// The shared vectors that states parked at the same point are diffed
+/// against, see ExecutionState::park.
+struct ParkBase {
+  ParkedVector<ref<Expr> >::Base constraints;
+  ParkedVector<ref<Expr> >::Base rewrittenConstraints;
+  ParkedVector<RebaseID>::Base history;
+};
+
 /// @brief ExecutionState representing a path under exploration
 class ExecutionState {
 public:
@@ -193,9 +310,28 @@ private:
 
   static uint64_t globalArrayID;
 
-  std::map<const Array *, const Array *> rewriteCache;
+  std::map<ArrayHolder, ArrayHolder> rewriteCache;
+
+  static LRUCache<ArrayHolder, ArrayHolder> globalRewriteCache;
+
+  struct Parked {
+    ParkedVector<ref<Expr> > constraints;
+    ParkedVector<ref<Expr> > rewrittenConstraints;
+    ParkedVector<RebaseID> history;
+    /* the bytes held, and the bytes saved by the diffs */
+    size_t bytes;
+    size_t saved;
+  };
+
+  /* the compact form of the state while it is parked */
+  std::unique_ptr<Parked> parked;
 
-  static std::map<const Array *, const Array *> globalRewriteCache;
+  /* the state was parked before, it is counted once in stats::parkedStates */
+  bool wasParked;
+
+  /* the sums of Parked::bytes and Parked::saved over all parked states */
+  static size_t parkedBytes;
+  static size_t parkedBytesSaved;
 
 public:
   // Execution - Control Flow specific
@@ -279,8 +415,14 @@ public:
   /* TODO: add docs */
   ConstraintManager rewrittenConstraints;
 
-  /* TODO: add docs */
-  char *local_next_slot;
+  /* the allocation state used in --local-address-space mode */
+  LocalSpace localSpace;
+
+  /* profile group -> address of the segment holding its objects */
+  std::map<uint64_t, uint64_t> profiledSegments;
+
+  /* the number of split objects, a hint for merging them back */
+  unsigned splitObjects;
 
 private:
   ExecutionState() : ptreeNode(0) {}
@@ -304,6 +446,9 @@ public:
   void addSymbolic(const MemoryObject *mo, const Array *array);
   void addConstraint(ref<Expr> e);
 
+  /// Whether merge would succeed, checked without the constraints, so the
+  /// state may be parked.
+  bool canMerge(const ExecutionState &b) const;
   bool merge(const ExecutionState &b);
   void dumpStack(llvm::raw_ostream &out) const;
 
@@ -320,6 +465,20 @@ public:
 
   ref<AddressRecord> getAddressConstraint(uint64_t id) const;
 
+  /// Store the constraints and the relocation history as diffs against
+  /// base while the state waits, e.g. at a klee_close_merge. The address
+  /// space needs no such treatment, it is already shared with the other
+  /// states through its immutable map. The state must be unparked before
+  /// it runs or is inspected again.
+  void park(ParkBase &base);
+  void unpark();
+  bool isParked() const { return parked != nullptr; }
+
+  /// The bytes of constraints and relocation history currently held by
+  /// parked states, and the bytes saved by storing them as diffs.
+  static size_t getParkedBytes() { return parkedBytes; }
+  static size_t getParkedBytesSaved() { return parkedBytesSaved; }
+
   void removeAddressConstraint(uint64_t id);
 
   const AddressConstraints &getAddressConstraints() const {
@@ -346,7 +505,7 @@ public:
 
   void updateRewrittenObjects();
 
-  void addRebaseID(RebaseID &rid) {
+  void addRebaseID(const RebaseID &rid) {
     history.push_back(rid);
   }
 
@@ -210,6 +210,10 @@ public:
   Expr() : refCount(0) { Expr::count++; flag = false; }
   virtual ~Expr() { Expr::count--; } 
 
+  /// Expressions are allocated from per-size pools.
+  static void *operator new(size_t size);
+  static void operator delete(void *p, size_t size);
+
   virtual Kind getKind() const = 0;
   virtual Width getWidth() const = 0;
   
@@ -477,9 +481,26 @@ public:
 
   unsigned getSize() const { return size; }
 
+  /// Number of consecutive array elements written by this update, starting
+  /// at index, for an array with the given range. An update of several
+  /// elements holds them in value, the element at index in the low bits.
+  unsigned getNumElements(Expr::Width range) const {
+    return value->getWidth() / range;
+  }
+
+  /// Index of the k-th element written by this update.
+  ref<Expr> getElementIndex(unsigned k) const;
+
+  /// Value of the k-th element written by this update.
+  ref<Expr> getElementValue(unsigned k, Expr::Width range) const;
+
   int compare(const UpdateNode &b) const;  
   unsigned hash() const { return hashValue; }
 
+  /// Update nodes are allocated from a pool.
+  static void *operator new(size_t size);
+  static void operator delete(void *p, size_t size);
+
 private:
   UpdateNode() : refCount(0) {}
   ~UpdateNode();
@@ -512,6 +533,14 @@ public:
 private:
   unsigned hashValue;
 
+  /// Number of update lists and ArrayHolders referring to this array.
+  mutable unsigned refCount;
+  /// Set by ArrayCache::release, the array is then freed as soon as the
+  /// reference count drops to zero.
+  mutable bool released;
+  /// The cache that created the array, null once it was destroyed.
+  mutable ArrayCache *cache;
+
   // FIXME: Make =delete when we switch to C++11
   Array(const Array& array);
 
@@ -547,6 +576,17 @@ public:
   friend class ArrayCache;
 };
 
+/// Notified right before an array is freed, so that caches keyed by the
+/// address of the array can drop their entries. Listeners register
+/// themselves on construction.
+class ArrayFreeListener {
+public:
+  ArrayFreeListener();
+  virtual ~ArrayFreeListener();
+
+  virtual void arrayFreed(const Array *array) = 0;
+};
+
 /// Class representing a complete list of updates into an array.
 class UpdateList { 
   friend class ReadExpr; // for default constructor
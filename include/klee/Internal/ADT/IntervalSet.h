@@ -0,0 +1,102 @@
+//===-- IntervalSet.h -------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_INTERVALSET_H
+#define KLEE_INTERVALSET_H
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+
+namespace klee {
+
+  /// A set of unsigned values, stored as disjoint half-open intervals. Used
+  /// where large contiguous runs are expected, so the cost depends on the
+  /// number of runs and not on the number of values.
+  class IntervalSet {
+    typedef std::map<unsigned, unsigned> map_ty;
+
+    /// begin -> end (exclusive), disjoint and not adjacent
+    map_ty intervals;
+
+  public:
+    bool empty() const { return intervals.empty(); }
+    void clear() { intervals.clear(); }
+
+    bool contains(unsigned value) const {
+      return skip(value) != value;
+    }
+
+    /// Returns the end of the interval containing value, or value itself if
+    /// it is not in the set.
+    unsigned skip(unsigned value) const {
+      map_ty::const_iterator it = intervals.upper_bound(value);
+      if (it == intervals.begin())
+        return value;
+      --it;
+      return value < it->second ? it->second : value;
+    }
+
+    /// Adds [begin, end).
+    void insert(unsigned begin, unsigned end) {
+      if (begin >= end)
+        return;
+
+      map_ty::iterator it = intervals.upper_bound(begin);
+      if (it != intervals.begin()) {
+        map_ty::iterator prev = std::prev(it);
+        if (prev->second >= begin) {
+          begin = prev->first;
+          end = std::max(end, prev->second);
+          intervals.erase(prev);
+        }
+      }
+      while (it != intervals.end() && it->first <= end) {
+        end = std::max(end, it->second);
+        it = intervals.erase(it);
+      }
+      intervals[begin] = end;
+    }
+
+    /// Removes [begin, end).
+    void erase(unsigned begin, unsigned end) {
+      if (begin >= end)
+        return;
+
+      map_ty::iterator it = intervals.upper_bound(begin);
+      if (it != intervals.begin()) {
+        map_ty::iterator prev = std::prev(it);
+        if (prev->second > begin) {
+          unsigned prevEnd = prev->second;
+          if (prev->first == begin) {
+            intervals.erase(prev);
+          } else {
+            prev->second = begin;
+          }
+          if (prevEnd > end) {
+            intervals[end] = prevEnd;
+            return;
+          }
+        }
+      }
+      while (it != intervals.end() && it->first < end) {
+        if (it->second > end) {
+          unsigned itEnd = it->second;
+          intervals.erase(it);
+          intervals[end] = itEnd;
+          return;
+        }
+        it = intervals.erase(it);
+      }
+    }
+  };
+
+}
+
+#endif /* KLEE_INTERVALSET_H */
@@ -0,0 +1,110 @@
+//===-- LRUCache.h ----------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_LRUCACHE_H
+#define KLEE_LRUCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <utility>
+
+namespace klee {
+
+  /// A map with a bounded number of entries. When the bound is reached, the
+  /// least recently used entries are evicted. A capacity of zero means the
+  /// cache is unbounded.
+  template<class K, class V>
+  class LRUCache {
+    typedef std::list<std::pair<K, V> > list_ty;
+    typedef std::map<K, typename list_ty::iterator> index_ty;
+
+    /// most recently used entries first
+    list_ty entries;
+    index_ty index;
+    size_t capacity;
+
+    void rebuildIndex() {
+      index.clear();
+      for (typename list_ty::iterator it = entries.begin(),
+             ie = entries.end(); it != ie; ++it)
+        index[it->first] = it;
+    }
+
+  public:
+    explicit LRUCache(size_t capacity = 0) : capacity(capacity) {}
+
+    LRUCache(const LRUCache &other)
+      : entries(other.entries), capacity(other.capacity) {
+      rebuildIndex();
+    }
+
+    LRUCache &operator=(const LRUCache &other) {
+      if (this != &other) {
+        entries = other.entries;
+        capacity = other.capacity;
+        rebuildIndex();
+      }
+      return *this;
+    }
+
+    /// Returns the cached value (and marks it as recently used), or null.
+    V *find(const K &key) {
+      typename index_ty::iterator it = index.find(key);
+      if (it == index.end())
+        return 0;
+      entries.splice(entries.begin(), entries, it->second);
+      return &it->second->second;
+    }
+
+    /// Inserts or updates an entry, returns the number of evicted entries.
+    size_t insert(const K &key, const V &value) {
+      typename index_ty::iterator it = index.find(key);
+      if (it != index.end()) {
+        it->second->second = value;
+        entries.splice(entries.begin(), entries, it->second);
+        return 0;
+      }
+
+      entries.push_front(std::make_pair(key, value));
+      index[key] = entries.begin();
+      return shrink();
+    }
+
+    /// Sets the bound, evicting entries if needed. Returns the number of
+    /// evicted entries.
+    size_t setCapacity(size_t c) {
+      capacity = c;
+      return shrink();
+    }
+
+    size_t getCapacity() const { return capacity; }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    void clear() {
+      entries.clear();
+      index.clear();
+    }
+
+  private:
+    size_t shrink() {
+      size_t evicted = 0;
+      while (capacity && entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+        evicted++;
+      }
+      return evicted;
+    }
+  };
+
+}
+
+#endif /* KLEE_LRUCACHE_H */
@@ -0,0 +1,100 @@
+//===-- NodePool.h ----------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_NODEPOOL_H
+#define KLEE_NODEPOOL_H
+
+#include <cstddef>
+#include <new>
+
+namespace klee {
+
+  /// Allocates blocks of a fixed size from large slabs. Freed blocks are
+  /// kept in a free list and reused, the slabs are never returned to the
+  /// system. Not thread safe.
+  class FixedSizePool {
+    struct FreeBlock {
+      FreeBlock *next;
+    };
+
+    static const size_t SlabSize = 64 * 1024;
+
+    size_t blockSize;
+    FreeBlock *freeList;
+    char *slab;
+    size_t slabUsed;
+
+  public:
+    explicit FixedSizePool(size_t size = sizeof(FreeBlock))
+      : blockSize(size < sizeof(FreeBlock) ? sizeof(FreeBlock) : size),
+        freeList(0), slab(0), slabUsed(SlabSize) {}
+
+    void setBlockSize(size_t size) {
+      blockSize = size < sizeof(FreeBlock) ? sizeof(FreeBlock) : size;
+    }
+
+    void *allocate() {
+      if (freeList) {
+        FreeBlock *b = freeList;
+        freeList = b->next;
+        return b;
+      }
+
+      if (slabUsed + blockSize > SlabSize) {
+        slab = static_cast<char *>(::operator new(SlabSize));
+        slabUsed = 0;
+      }
+      void *p = slab + slabUsed;
+      slabUsed += blockSize;
+      return p;
+    }
+
+    void deallocate(void *p) {
+      FreeBlock *b = static_cast<FreeBlock *>(p);
+      b->next = freeList;
+      freeList = b;
+    }
+  };
+
+  /// A set of fixed size pools, one for each size class up to MaxSize.
+  /// Larger requests go to the global allocator.
+  class SizeClassPool {
+    static const size_t Granularity = 8;
+    static const size_t MaxSize = 256;
+
+    FixedSizePool pools[MaxSize / Granularity];
+
+    static size_t sizeClass(size_t size) {
+      return size ? (size - 1) / Granularity : 0;
+    }
+
+  public:
+    SizeClassPool() {
+      for (size_t i = 0; i != MaxSize / Granularity; ++i)
+        pools[i].setBlockSize((i + 1) * Granularity);
+    }
+
+    void *allocate(size_t size) {
+      if (size > MaxSize)
+        return ::operator new(size);
+      return pools[sizeClass(size)].allocate();
+    }
+
+    void deallocate(void *p, size_t size) {
+      if (size > MaxSize) {
+        ::operator delete(p);
+        return;
+      }
+      pools[sizeClass(size)].deallocate(p);
+    }
+  };
+
+}
+
+#endif /* KLEE_NODEPOOL_H */
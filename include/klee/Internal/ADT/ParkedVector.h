@@ -0,0 +1,77 @@
+//===-- ParkedVector.h ------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_PARKEDVECTOR_H
+#define KLEE_PARKEDVECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace klee {
+
+  /// A vector stored as the common prefix with a shared base vector plus
+  /// its own suffix. Vectors that grew from a common ancestor, such as the
+  /// constraints of states forked from the same state, share most of their
+  /// elements this way.
+  template <typename T>
+  class ParkedVector {
+  public:
+    typedef std::shared_ptr<const std::vector<T> > Base;
+
+  private:
+    Base base;
+    size_t shared = 0;
+    std::vector<T> suffix;
+
+    static size_t bytes(const std::vector<T> &v) {
+      return v.capacity() * sizeof(T);
+    }
+
+  public:
+    /// Move the elements of v into this diff against b, which is set to
+    /// the elements of v if it is still empty. v is left empty. Returns
+    /// the bytes held by v before, and the bytes held by the diff after
+    /// parking, including b when this call created it.
+    std::pair<size_t, size_t> park(std::vector<T> &v, Base &b) {
+      size_t before = bytes(v);
+      if (!b) {
+        b = std::make_shared<const std::vector<T> >(std::move(v));
+        base = b;
+        shared = b->size();
+        std::vector<T>().swap(v);
+        return std::make_pair(before, bytes(*b));
+      }
+
+      base = b;
+      size_t n = std::min(v.size(), b->size());
+      shared = 0;
+      while (shared < n && v[shared] == (*b)[shared])
+        ++shared;
+      suffix.assign(v.begin() + shared, v.end());
+      std::vector<T>().swap(v);
+      return std::make_pair(before, bytes(suffix));
+    }
+
+    /// Rebuild the elements into v.
+    void unpark(std::vector<T> &v) {
+      v.clear();
+      v.reserve(shared + suffix.size());
+      v.insert(v.end(), base->begin(), base->begin() + shared);
+      v.insert(v.end(), suffix.begin(), suffix.end());
+      base.reset();
+      shared = 0;
+      std::vector<T>().swap(suffix);
+    }
+  };
+
+}
+
+#endif /* KLEE_PARKEDVECTOR_H */
@@ -0,0 +1,74 @@
+//===-- RingBuffer.h --------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_RINGBUFFER_H
+#define KLEE_RINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace klee {
+
+  /// A bounded lock-free queue for exactly one producer and one consumer
+  /// thread. The capacity is rounded up to a power of two. Pushing into a
+  /// full buffer fails instead of blocking, so the producer never waits for
+  /// the consumer.
+  template <typename T>
+  class RingBuffer {
+    std::vector<T> slots;
+    size_t mask;
+
+    /// Both counters only grow, their difference is the number of elements.
+    std::atomic<size_t> head; // next slot to write, owned by the producer
+    std::atomic<size_t> tail; // next slot to read, owned by the consumer
+
+    static size_t roundUp(size_t n) {
+      size_t size = 1;
+      while (size < n)
+        size <<= 1;
+      return size;
+    }
+
+  public:
+    explicit RingBuffer(size_t capacity)
+      : slots(roundUp(capacity ? capacity : 1)), mask(slots.size() - 1),
+        head(0), tail(0) {}
+
+    RingBuffer(const RingBuffer &) = delete;
+    RingBuffer &operator=(const RingBuffer &) = delete;
+
+    size_t capacity() const { return slots.size(); }
+
+    /// Producer side. Returns false if the buffer is full.
+    bool push(const T &value) {
+      size_t h = head.load(std::memory_order_relaxed);
+      if (h - tail.load(std::memory_order_acquire) == slots.size())
+        return false;
+      slots[h & mask] = value;
+      head.store(h + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// Consumer side. Moves up to max elements into out and returns how many
+    /// were moved.
+    size_t pop(T *out, size_t max) {
+      size_t t = tail.load(std::memory_order_relaxed);
+      size_t available = head.load(std::memory_order_acquire) - t;
+      size_t n = available < max ? available : max;
+      for (size_t i = 0; i != n; ++i)
+        out[i] = slots[(t + i) & mask];
+      tail.store(t + n, std::memory_order_release);
+      return n;
+    }
+  };
+
+}
+
+#endif /* KLEE_RINGBUFFER_H */
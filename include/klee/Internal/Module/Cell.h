@@ -15,8 +15,39 @@
 namespace klee {
   class MemoryObject;
 
+  /// A register. Concrete integers of up to 64 bits computed by the
+  /// executor's fast paths are stored inline in concrete/width, and the
+  /// ConstantExpr is only created once the value is needed as an
+  /// expression (see Executor::eval).
   struct Cell {
-    ref<Expr> value;
+    /// The value, null while a concrete value is only held inline. It
+    /// is filled in on demand even through const cells, as that does not
+    /// change the value the cell holds.
+    mutable ref<Expr> value;
+
+    /// The inline concrete value, valid if width is not 0.
+    uint64_t concrete = 0;
+    Expr::Width width = 0;
+
+    bool isConcrete() const { return width != 0; }
+
+    void set(ref<Expr> e) {
+      value = e;
+      width = 0;
+    }
+
+    void setConcrete(uint64_t v, Expr::Width w) {
+      value = nullptr;
+      concrete = v;
+      width = w;
+    }
+
+    /// Make value valid, creating the ConstantExpr if needed.
+    const ref<Expr> &materialize() const {
+      if (value.isNull() && width)
+        value = ConstantExpr::create(concrete, width);
+      return value;
+    }
   };
 }
 
@@ -28,12 +28,63 @@ namespace klee {
   class KModule;
 
 
+  /// Compact opcodes assigned when the KInstructions are built. The
+  /// executor has a specialized handler for each of them, every other
+  /// instruction is Generic and goes through the full
+  /// Executor::executeInstruction.
+  enum class KOpcode : uint8_t {
+    Generic,
+    // integer arithmetic
+    Add, Sub, Mul, And, Or, Xor, Shl, LShr, AShr,
+    // integer comparisons
+    Eq, Ne, Ugt, Uge, Ult, Ule, Sgt, Sge, Slt, Sle,
+    // integer conversions
+    Trunc, ZExt, SExt, BitCast,
+    // unconditional branch
+    Br,
+    PHI,
+    NumOpcodes
+  };
+
+  /// An operand resolved when decoding, so that the handlers neither decode
+  /// the value number nor look up integer constants.
+  struct KOperand {
+    enum Kind : uint8_t {
+      /// value is the register index
+      Register,
+      /// value is the index into the module constant table
+      Constant,
+      /// value is an integer constant of at most 64 bits, of the given width
+      Inline
+    };
+
+    Kind kind = Register;
+    unsigned width = 0;
+    uint64_t value = 0;
+  };
+
   /// KInstruction - Intermediate instruction representation used
   /// during execution.
   struct KInstruction {
     llvm::Instruction *inst;    
     const InstructionInfo *info;
 
+    KOpcode opcode = KOpcode::Generic;
+
+    /// Trunc, ZExt and SExt: the width of the result.
+    unsigned width = 0;
+
+    /// Br: the index of the first instruction of the successor in the
+    /// function, and the incoming block index of its PHI nodes (-1 if the
+    /// successor does not start with a PHI node).
+    unsigned successor = 0;
+    int successorIncoming = -1;
+
+    /// The resolved operands of the arithmetic, comparison and conversion
+    /// handlers, which take at most two. PHI nodes select their operand at
+    /// run time and go through operands.
+    KOperand slots[2];
+
     /// Value numbers for each operand. -1 is an invalid value,
     /// otherwise negative numbers are indices (negated and offset by
     /// 2) into the module constant table and positive numbers are
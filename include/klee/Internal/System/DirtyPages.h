@@ -0,0 +1,45 @@
+//===-- DirtyPages.h --------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_UTIL_DIRTYPAGES_H
+#define KLEE_UTIL_DIRTYPAGES_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace klee {
+  namespace util {
+    /// Finds the pages of the process written since the last reset, using
+    /// the soft-dirty bits of Linux (/proc/self/clear_refs and
+    /// /proc/self/pagemap). Not available on other systems, or when the
+    /// kernel does not track soft-dirty bits.
+    class DirtyPageTracker {
+      int pagemap;
+      size_t pageSize;
+
+      bool clear();
+      bool isDirty(uint64_t page, bool &dirty);
+
+    public:
+      DirtyPageTracker();
+      ~DirtyPageTracker();
+
+      bool isAvailable() const { return pagemap >= 0; }
+
+      /// Clears the soft-dirty bits of all the pages of the process.
+      void reset();
+
+      /// Returns false only if no page in [address, address + size) was
+      /// written since the last reset.
+      bool mayBeDirty(uint64_t address, size_t size);
+    };
+  }
+}
+
+#endif
@@ -71,6 +71,7 @@
 
 #include <vector>
 #include <map>
+#include <memory>
 #include <stdint.h>
 #include "llvm/Support/CommandLine.h"
 
@@ -89,6 +90,7 @@ extern llvm::cl::opt<bool> DebugLogIncompleteMerge;
 
 class Executor;
 class ExecutionState;
+struct ParkBase;
 
 /// @brief Represents one `klee_open_merge()` call. 
 /// Handles merging of states that branched from it
@@ -110,6 +112,9 @@ private:
   /// @brief Get distance of state from the openInstruction
   unsigned getInstructionDistance(ExecutionState *es);
 
+  /// @brief Park a state that waits at the 'klee_close_merge' call mp
+  void parkState(ExecutionState *es, llvm::Instruction *mp);
+
   /// @brief States that ran through the klee_open_merge, but not yet into a
   /// corresponding klee_close_merge
   std::vector<ExecutionState *> openStates;
@@ -119,6 +124,10 @@ private:
   std::map<llvm::Instruction *, std::vector<ExecutionState *> >
       reachedCloseMerge;
 
+  /// @brief The base that the states waiting at each 'klee_close_merge' call
+  /// are parked against
+  std::map<llvm::Instruction *, std::shared_ptr<ParkBase> > parkBases;
+
 public:
 
   /// @brief Called when a state runs into a 'klee_close_merge()' call
@@ -43,6 +43,7 @@ namespace klee {
     std::vector<Statistic*> stats;
     uint64_t *globalStats;
     uint64_t *indexedStats;
+    unsigned totalIndices;
     StatisticRecord *contextStats;
     unsigned index;
 
@@ -67,6 +68,9 @@ namespace klee {
                                uint64_t addend) const;
     uint64_t getIndexedValue(const Statistic &s, unsigned index) const;
     void setIndexedValue(const Statistic &s, unsigned index, uint64_t value);
+    /// Copy all indexed values into out, laid out like getIndexedValue
+    /// expects (index * getNumStatistics() + statistic id).
+    void copyIndexedValues(std::vector<uint64_t> &out) const;
     int getStatisticID(const std::string &name) const;
     Statistic *getStatisticByName(const std::string &name) const;
   };
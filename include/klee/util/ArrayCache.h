@@ -71,12 +71,61 @@ public:
     return cachedSymbolicArrays.size();
   }
 
+  /// Give up the ownership of a constant array. The array is freed as soon
+  /// as no update list or ArrayHolder refers to it any more, so it must not
+  /// be kept by plain pointer elsewhere.
+  void release(const Array *array);
+
+  /// Reference counting of arrays, done by UpdateList and ArrayHolder.
+  static void retain(const Array *array) { ++array->refCount; }
+  static void drop(const Array *array);
+
 private:
   typedef unordered_set<const Array *, klee::ArrayHashFn,
                         klee::EquivArrayCmpFn> ArrayHashMap;
   ArrayHashMap cachedSymbolicArrays;
-  typedef std::vector<const Array *> ArrayPtrVec;
-  ArrayPtrVec concreteArrays;
+  typedef unordered_set<const Array *> ArrayPtrSet;
+  ArrayPtrSet concreteArrays;
+
+  static void free(const Array *array);
+};
+
+/// A counted reference to an array, for keeping arrays that may have been
+/// released (see ArrayCache::release) outside of update lists.
+class ArrayHolder {
+  const Array *array;
+
+public:
+  ArrayHolder(const Array *array = nullptr) : array(array) {
+    if (array)
+      ArrayCache::retain(array);
+  }
+
+  ArrayHolder(const ArrayHolder &other) : array(other.array) {
+    if (array)
+      ArrayCache::retain(array);
+  }
+
+  ~ArrayHolder() {
+    if (array)
+      ArrayCache::drop(array);
+  }
+
+  ArrayHolder &operator=(const ArrayHolder &other) {
+    if (other.array)
+      ArrayCache::retain(other.array);
+    if (array)
+      ArrayCache::drop(array);
+    array = other.array;
+    return *this;
+  }
+
+  const Array *get() const { return array; }
+
+  bool operator<(const ArrayHolder &other) const { return array < other.array; }
+  bool operator==(const ArrayHolder &other) const {
+    return array == other.array;
+  }
 };
 }
 
@@ -45,10 +45,10 @@ struct UpdateNodeCmpFn {
 };  
 
 template<class T>
-class ArrayExprHash {  
+class ArrayExprHash : public ArrayFreeListener {
 public:
   
-  ArrayExprHash() {};
+  ArrayExprHash() : _hashed_arrays(0) {};
   // Note: Extend the class and overload the destructor if the objects of type T
   // that are to be hashed need to be explicitly destroyed
   // As an example, see class STPArrayExprHash
@@ -59,6 +59,10 @@ public:
   
   bool lookupUpdateNodeExpr(const UpdateNode* un, T& exp) const;
   void hashUpdateNodeExpr(const UpdateNode* un, T& exp);  
+
+  /// Drops the expression of an array that is about to be freed. Extend
+  /// this as well if the objects need to be explicitly destroyed.
+  virtual void arrayFreed(const Array *array) { _array_hash.erase(array); }
   
 protected:
   typedef std::unordered_map<const Array*, T, ArrayHashFn, ArrayCmpFn> ArrayHash;
@@ -71,6 +75,8 @@ protected:
   
   ArrayHash      _array_hash;
   UpdateNodeHash _update_node_hash;  
+  /// Number of arrays hashed so far, freed arrays included.
+  unsigned _hashed_arrays;
 };
 
 
@@ -99,6 +105,8 @@ void ArrayExprHash<T>::hashArrayExpr(const Array* array, T& exp) {
 #endif
    
    assert(array);
+  if (_array_hash.find(array) == _array_hash.end())
+    ++_hashed_arrays;
   _array_hash[array] = exp;
 }
 
@@ -35,6 +35,18 @@ public:
   void set(unsigned idx) { bits[idx/32] |= 1<<(idx&0x1F); }
   void unset(unsigned idx) { bits[idx/32] &= ~(1<<(idx&0x1F)); }
   void set(unsigned idx, bool value) { if (value) set(idx); else unset(idx); }
+
+  /// Sets (or unsets) count bits starting at idx, a word at a time where
+  /// possible.
+  void setRange(unsigned idx, unsigned count, bool value) {
+    unsigned end = idx + count;
+    for (; idx < end && (idx & 0x1F); ++idx)
+      set(idx, value);
+    for (; idx + 32 <= end; idx += 32)
+      bits[idx/32] = value ? 0xFFFFFFFF : 0;
+    for (; idx < end; ++idx)
+      set(idx, value);
+  }
 };
 
 } // End klee namespace
@@ -61,8 +61,17 @@ protected:
 
   T evalRead(const UpdateList &ul, T index);
 
+private:
+  /// maxDepth - Expressions nested deeper than this evaluate to the full
+  /// range of their width (0 for no limit).
+  unsigned maxDepth;
+  unsigned depth;
+
+  T evaluateActual(const ref<Expr> &e);
+
 public:
-  ExprRangeEvaluator() {}
+  explicit ExprRangeEvaluator(unsigned maxDepth = 0)
+      : maxDepth(maxDepth), depth(0) {}
   virtual ~ExprRangeEvaluator() {}
 
   T evaluate(const ref<Expr> &e);
@@ -74,15 +83,21 @@ T ExprRangeEvaluator<T>::evalRead(const UpdateList &ul,
   T res;
 
   for (const UpdateNode *un=ul.head; un; un=un->next) {
-    T ui = evaluate(un->index);
-
-    if (ui.mustEqual(index)) {
-      return res.set_union(evaluate(un->value));
-    } else if (ui.mayEqual(index)) {
-      res = res.set_union(evaluate(un->value));
-      if (res.isFullRange(8)) {
-        return res;
-      } 
+    // an update may write several consecutive elements
+    unsigned elements = un->getNumElements(ul.root->getRange());
+    for (unsigned k = 0; k != elements; ++k) {
+      T ui = evaluate(un->getElementIndex(k));
+
+      if (ui.mustEqual(index)) {
+        return res.set_union(
+            evaluate(un->getElementValue(k, ul.root->getRange())));
+      } else if (ui.mayEqual(index)) {
+        res = res.set_union(
+            evaluate(un->getElementValue(k, ul.root->getRange())));
+        if (res.isFullRange(8)) {
+          return res;
+        }
+      }
     }
   }
   
@@ -91,6 +106,17 @@ T ExprRangeEvaluator<T>::evalRead(const UpdateList &ul,
 
 template<class T>
 T ExprRangeEvaluator<T>::evaluate(const ref<Expr> &e) {
+  if (maxDepth && depth == maxDepth)
+    return T(0, bits64::maxValueOfNBits(e->getWidth()));
+
+  ++depth;
+  T res = evaluateActual(e);
+  --depth;
+  return res;
+}
+
+template<class T>
+T ExprRangeEvaluator<T>::evaluateActual(const ref<Expr> &e) {
   switch (e->getKind()) {
   case Expr::Constant:
     return T(cast<ConstantExpr>(e));
@@ -122,13 +148,44 @@ T ExprRangeEvaluator<T>::evaluate(const ref<Expr> &e) {
 
     // XXX these should be unrolled to ensure nice inline
   case Expr::Concat: {
+    // Each kid is shifted by its own width, as long as the result fits.
     const Expr *ep = e.get();
+    if (ep->getWidth() > 64)
+      break;
     T res(0);
-    for (unsigned i=0; i<ep->getNumKids(); i++)
-      res = res.concat(evaluate(ep->getKid(i)),8);
+    for (unsigned i=0; i<ep->getNumKids(); i++) {
+      ref<Expr> kid = ep->getKid(i);
+      res = res.concat(evaluate(kid), kid->getWidth());
+    }
     return res;
   }
 
+    // Casts
+
+  case Expr::ZExt: {
+    const CastExpr *ce = cast<CastExpr>(e);
+    return evaluate(ce->src);
+  }
+  case Expr::SExt: {
+    // Same value as long as the sign bit can't be set.
+    const CastExpr *ce = cast<CastExpr>(e);
+    T src = evaluate(ce->src);
+    unsigned width = ce->src->getWidth();
+    if (width <= 64 && src.max() <= bits64::maxValueOfNBits(width - 1))
+      return src;
+    break;
+  }
+  case Expr::Extract: {
+    // Truncation keeps the value as long as it fits.
+    const ExtractExpr *ee = cast<ExtractExpr>(e);
+    if (ee->offset == 0 && ee->expr->getWidth() <= 64) {
+      T src = evaluate(ee->expr);
+      if (src.max() <= bits64::maxValueOfNBits(ee->width))
+        return src;
+    }
+    break;
+  }
+
     // Arithmetic
 
   case Expr::Add: {
@@ -17,6 +17,7 @@ StatisticManager::StatisticManager()
   : enabled(true),
     globalStats(0),
     indexedStats(0),
+    totalIndices(0),
     contextStats(0),
     index(0) {
 }
@@ -30,6 +31,13 @@ void StatisticManager::useIndexedStats(unsigned totalIndices) {
   delete[] indexedStats;
   indexedStats = new uint64_t[totalIndices * stats.size()];
   memset(indexedStats, 0, sizeof(*indexedStats) * totalIndices * stats.size());
+  this->totalIndices = totalIndices;
+}
+
+void StatisticManager::copyIndexedValues(std::vector<uint64_t> &out) const {
+  out.resize(totalIndices * stats.size());
+  if (!out.empty())
+    memcpy(out.data(), indexedStats, sizeof(*indexedStats) * out.size());
 }
 
 void StatisticManager::registerStatistic(Statistic &s) {
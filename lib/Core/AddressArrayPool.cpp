@@ -0,0 +1,35 @@
+//===-- AddressArrayPool.cpp ----------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AddressArrayPool.h"
+#include "Context.h"
+
+#include "klee/util/ArrayCache.h"
+
+#include "llvm/ADT/StringExtras.h"
+
+#include <algorithm>
+
+using namespace klee;
+
+void AddressArrayPool::grow(uint64_t n) {
+  unsigned bytes = Context::get().getPointerWidth() / 8;
+  size_t newSize = std::max((size_t)(n + 1), entries.size() + ChunkSize);
+  entries.reserve(newSize);
+
+  std::vector<ref<Expr>> kids(bytes);
+  for (size_t k = entries.size(); k < newSize; k++) {
+    const Array *array = arrayCache->CreateArray("addr_" + llvm::utostr(k), bytes);
+    for (unsigned i = 0; i < bytes; i++) {
+      kids[i] = ReadExpr::create(UpdateList(array, nullptr),
+                                 ConstantExpr::create(bytes - i - 1, Expr::Int32));
+    }
+    entries.push_back(Entry(array, ConcatExpr::createN(bytes, &kids[0])));
+  }
+}
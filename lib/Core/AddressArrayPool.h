@@ -0,0 +1,62 @@
+//===-- AddressArrayPool.h --------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_ADDRESSARRAYPOOL_H
+#define KLEE_ADDRESSARRAYPOOL_H
+
+#include "klee/Expr.h"
+
+#include <vector>
+
+namespace klee {
+
+class ArrayCache;
+
+/// The symbolic address arrays (addr_N) and their pointer-sized value
+/// expressions, indexed by N. Entries are created in chunks ahead of use, so
+/// that symbolizing an address does not format names or build expressions.
+class AddressArrayPool {
+public:
+  struct Entry {
+    const Array *array;
+    /* the value of the array as a pointer */
+    ref<Expr> alpha;
+
+    Entry(const Array *array, ref<Expr> alpha) : array(array), alpha(alpha) {
+
+    }
+  };
+
+  static const size_t ChunkSize = 1024;
+
+  AddressArrayPool(ArrayCache *arrayCache) : arrayCache(arrayCache) {
+
+  }
+
+  const Entry &get(uint64_t n) {
+    if (n >= entries.size()) {
+      grow(n);
+    }
+    return entries[n];
+  }
+
+  size_t size() const {
+    return entries.size();
+  }
+
+private:
+  ArrayCache *arrayCache;
+  std::vector<Entry> entries;
+
+  void grow(uint64_t n);
+};
+
+}
+
+#endif /* KLEE_ADDRESSARRAYPOOL_H */
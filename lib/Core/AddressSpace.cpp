@@ -10,6 +10,7 @@
 #include "AddressSpace.h"
 #include "CoreStats.h"
 #include "Memory.h"
+#include "MemoryManager.h"
 #include "TimingSolver.h"
 #include "AllocationContext.h"
 
@@ -18,10 +19,34 @@
 #include "klee/Constraints.h"
 #include "klee/util/ExprUtil.h"
 #include "klee/ExecutionState.h"
+#include "klee/OptionCategories.h"
+#include "klee/Internal/System/DirtyPages.h"
+
+#include "llvm/Support/CommandLine.h"
 
 using namespace klee;
 using namespace llvm;
 
+namespace {
+cl::opt<bool> CopyOutChangedOnly(
+    "copy-out-changed-only",
+    cl::desc("Before an external call, copy out only the objects whose native "
+             "memory does not hold their current contents (default=true)"),
+    cl::init(true), cl::cat(ExtCallsCat));
+
+cl::opt<bool> TrackExternalWrites(
+    "track-external-writes",
+    cl::desc("After an external call, copy in only the objects on pages "
+             "written during the call, using soft-dirty bits (Linux only, "
+             "default=false)"),
+    cl::init(false), cl::cat(ExtCallsCat));
+
+util::DirtyPageTracker &getDirtyPageTracker() {
+  static util::DirtyPageTracker tracker;
+  return tracker;
+}
+}
+
 ///
 
 void AddressSpace::bindObject(const MemoryObject *mo, ObjectState *os) {
@@ -30,6 +55,12 @@ void AddressSpace::bindObject(const MemoryObject *mo, ObjectState *os) {
   objects = objects.replace(std::make_pair(mo, os));
 }
 
+void AddressSpace::bindSharedObject(const MemoryObject *mo,
+                                    const ObjectState *os) {
+  assert(os->copyOnWriteOwner==0 && "shared object has an owner");
+  objects = objects.replace(std::make_pair(mo, const_cast<ObjectState*>(os)));
+}
+
 void AddressSpace::unbindObject(const MemoryObject *mo) {
   const ObjectState *os = findObject(mo);
   if (os->updates.root) {
@@ -350,10 +381,20 @@ void AddressSpace::copyOutConcretes() {
       ObjectState *os = it->second;
       auto address = reinterpret_cast<std::uint8_t*>(mo->address);
 
-      if (!os->readOnly)
-        memcpy(address, os->concreteStore, mo->size);
+      if (os->readOnly)
+        continue;
+      if (CopyOutChangedOnly && mo->parent &&
+          mo->parent->hasNativeContents(mo, os->version))
+        continue;
+
+      memcpy(address, os->concreteStore, mo->size);
+      if (mo->parent)
+        mo->parent->setNativeContents(mo, os->version);
     }
   }
+
+  if (TrackExternalWrites)
+    getDirtyPageTracker().reset();
 }
 
 bool AddressSpace::copyInConcretes() {
@@ -364,6 +405,10 @@ bool AddressSpace::copyInConcretes() {
     if (!mo->isUserSpecified) {
       const ObjectState *os = it->second;
 
+      if (TrackExternalWrites &&
+          !getDirtyPageTracker().mayBeDirty(mo->address, mo->size))
+        continue;
+
       if (!copyInConcrete(mo, os, mo->address))
         return false;
     }
@@ -377,10 +422,15 @@ bool AddressSpace::copyInConcrete(const MemoryObject *mo, const ObjectState *os,
   auto address = reinterpret_cast<std::uint8_t*>(src_address);
   if (memcmp(address, os->concreteStore, mo->size) != 0) {
     if (os->readOnly) {
+      if (mo->parent)
+        mo->parent->clearNativeContents(mo);
       return false;
     } else {
       ObjectState *wos = getWriteable(mo, os);
       memcpy(wos->concreteStore, address, mo->size);
+      wos->markChanged();
+      if (mo->parent && src_address == mo->address)
+        mo->parent->setNativeContents(mo, wos->version);
     }
   }
   return true;
@@ -122,6 +122,11 @@ namespace klee {
     /// Add a binding to the address space.
     void bindObject(const MemoryObject *mo, ObjectState *os);
 
+    /// Add a binding to an object state that is never owned, so the
+    /// first write to it makes a copy. Used to share an immutable object
+    /// state between states.
+    void bindSharedObject(const MemoryObject *mo, const ObjectState *os);
+
     /// Remove a binding from the address space.
     void unbindObject(const MemoryObject *mo);
 
@@ -28,3 +28,15 @@ Statistic stats::states("States", "States");
 Statistic stats::trueBranches("TrueBranches", "Bt");
 Statistic stats::uncoveredInstructions("UncoveredInstructions", "Iuncov");
 Statistic stats::resolveQueries("ResolveQueries", "RQ");
+Statistic stats::rewriteCacheHits("RewriteCacheHits", "RWhits");
+Statistic stats::rewriteCacheMisses("RewriteCacheMisses", "RWmisses");
+Statistic stats::rewriteCacheEvictions("RewriteCacheEvictions", "RWevict");
+Statistic stats::rebases("Rebases", "Rb");
+Statistic stats::rebasedBytes("RebasedBytes", "RbB");
+Statistic stats::rebaseTime("RebaseTime", "Rbtime");
+Statistic stats::rebaseCacheHits("RebaseCacheHits", "RbChits");
+Statistic stats::splits("Splits", "Sp");
+Statistic stats::splitTime("SplitTime", "Sptime");
+Statistic stats::unfoldTime("UnfoldTime", "Utime");
+Statistic stats::rewriteTime("RewriteTime", "RWtime");
+Statistic stats::parkedStates("ParkedStates", "Pk");
@@ -48,6 +48,28 @@ namespace stats {
   extern Statistic minDistToReturn;
   extern Statistic resolveQueries;
 
+  /// Lookups and evictions in the bounded rewritten array caches.
+  extern Statistic rewriteCacheHits;
+  extern Statistic rewriteCacheMisses;
+  extern Statistic rewriteCacheEvictions;
+
+  /// Relocation of objects with symbolic addresses. The times are
+  /// inclusive: rebaseTime includes the rewriting of the constraints, which
+  /// is mostly unfoldTime, which includes rewriteTime.
+  extern Statistic rebases;
+  extern Statistic rebasedBytes;
+  extern Statistic rebaseTime;
+  /// Rebases that found the segment of an earlier rebase with the same id.
+  extern Statistic rebaseCacheHits;
+  extern Statistic splits;
+  extern Statistic splitTime;
+  extern Statistic unfoldTime;
+  extern Statistic rewriteTime;
+
+  /// Number of states parked at a klee_close_merge. The bytes they hold
+  /// are a current value, see ExecutionState::getParkedBytes.
+  extern Statistic parkedStates;
+
 }
 }
 
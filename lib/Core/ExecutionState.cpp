@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "CoreStats.h"
 #include "Memory.h"
 #include "MemoryManager.h"
 
@@ -18,6 +19,7 @@
 #include "klee/Internal/Module/KInstruction.h"
 #include "klee/Internal/Module/KModule.h"
 #include "klee/OptionCategories.h"
+#include "klee/TimerStatIncrementer.h"
 #include "klee/util/ExprUtil.h"
 #include "klee/util/ArrayCache.h"
 #include "klee/Internal/Support/ErrorHandling.h"
@@ -32,6 +34,7 @@
 #include <set>
 #include <sstream>
 #include <list>
+#include <unordered_set>
 #include <stdarg.h>
 
 using namespace llvm;
@@ -52,28 +55,66 @@ cl::opt<bool> klee::UseGlobalID("use-global-id", cl::init(false), cl::desc("..."
 
 cl::opt<bool> klee::UseGlobalRewriteCache("use-global-rewrite-cache", cl::init(true), cl::desc("..."));
 
+cl::opt<unsigned> klee::MaxRewriteCacheSize(
+    "max-rewrite-cache-size", cl::init(16384),
+    cl::desc("Maximum number of entries in each of the rewritten array caches, "
+             "least recently used entries are evicted (0=unlimited) "
+             "(default=16384)"));
+
 /***/
 
-StackFrame::StackFrame(KInstIterator _caller, KFunction *_kf)
-  : caller(_caller), kf(_kf), callPathNode(0), 
-    minDistToUncoveredOnReturn(0), varargs(0) {
-  locals = new Cell[kf->numRegisters];
+std::vector<std::vector<FrameLocals::Block *> > &FrameLocals::getFreeBlocks() {
+  // never destroyed, frames may still be released during static destruction
+  static auto *freeBlocks = new std::vector<std::vector<Block *> >();
+  return *freeBlocks;
+}
+
+FrameLocals::Block *FrameLocals::allocate(unsigned size) {
+  auto &freeBlocks = getFreeBlocks();
+  Block *b;
+  if (size < freeBlocks.size() && !freeBlocks[size].empty()) {
+    b = freeBlocks[size].back();
+    freeBlocks[size].pop_back();
+  } else {
+    b = new Block();
+    b->size = size;
+    b->cells = new Cell[size];
+  }
+  b->refCount = 1;
+  return b;
+}
+
+void FrameLocals::release() {
+  if (--block->refCount)
+    return;
+
+  for (unsigned i = 0; i < block->size; i++)
+    block->cells[i] = Cell();
+
+  auto &freeBlocks = getFreeBlocks();
+  if (block->size >= freeBlocks.size())
+    freeBlocks.resize(block->size + 1);
+  freeBlocks[block->size].push_back(block);
 }
 
-StackFrame::StackFrame(const StackFrame &s) 
-  : caller(s.caller),
-    kf(s.kf),
-    callPathNode(s.callPathNode),
-    allocas(s.allocas),
-    minDistToUncoveredOnReturn(s.minDistToUncoveredOnReturn),
-    varargs(s.varargs) {
-  locals = new Cell[s.kf->numRegisters];
-  for (unsigned i=0; i<s.kf->numRegisters; i++)
-    locals[i] = s.locals[i];
+void FrameLocals::unshare() {
+  Block *b = allocate(block->size);
+  for (unsigned i = 0; i < block->size; i++)
+    b->cells[i] = block->cells[i];
+  --block->refCount;
+  block = b;
 }
 
-StackFrame::~StackFrame() { 
-  delete[] locals; 
+FrameLocals &FrameLocals::operator=(const FrameLocals &other) {
+  ++other.block->refCount;
+  release();
+  block = other.block;
+  return *this;
+}
+
+StackFrame::StackFrame(KInstIterator _caller, KFunction *_kf)
+  : caller(_caller), kf(_kf), callPathNode(0), locals(_kf->numRegisters),
+    minDistToUncoveredOnReturn(0), varargs(0) {
 }
 
 AddressRecord::AddressRecord(uint64_t c, ref<Expr> alpha) : alpha(alpha), refCount(0) {
@@ -86,17 +127,90 @@ AddressRecord::AddressRecord(uint64_t c, ref<Expr> alpha) : alpha(alpha), refCou
   constraint = EqExpr::create(address, alpha);
 }
 
+namespace {
+
+struct RebaseIDHash {
+  unsigned operator()(const RebaseIDData *data) const {
+    return data->hash;
+  }
+};
+
+struct RebaseIDEquality {
+  bool operator()(const RebaseIDData *d1, const RebaseIDData *d2) const {
+    /* array sets are interned as well */
+    return d1->info == d2->info && d1->size == d2->size &&
+           d1->arrays == d2->arrays;
+  }
+};
+
+typedef std::unordered_set<const RebaseIDData *, RebaseIDHash, RebaseIDEquality>
+    RebaseIDTable;
+
+RebaseIDTable &getRebaseIDTable() {
+  static RebaseIDTable table;
+  return table;
+}
+
+std::set<Arrays> &getArraySets() {
+  static std::set<Arrays> sets;
+  return sets;
+}
+
+}
+
+RebaseID RebaseID::create(const InstructionInfo *info,
+                          size_t size,
+                          const Arrays &arrays,
+                          const std::vector<uint64_t> &addrs,
+                          const std::vector<AllocationContext> &acs) {
+  /* the order is part of the identity, it determines the segment layout */
+  const Arrays *interned = &*getArraySets().insert(arrays).first;
+
+  unsigned hash = (unsigned)(uintptr_t)info;
+  hash = hash * Expr::MAGIC_HASH_CONSTANT + (unsigned)size;
+  hash = hash * Expr::MAGIC_HASH_CONSTANT + (unsigned)(uintptr_t)interned;
+
+  RebaseIDData key;
+  key.info = info;
+  key.size = size;
+  key.arrays = interned;
+  key.hash = hash;
+
+  RebaseIDTable &table = getRebaseIDTable();
+  auto i = table.find(&key);
+  if (i != table.end()) {
+    return RebaseID(*i);
+  }
+
+  RebaseIDData *data = new RebaseIDData(key);
+  data->sortedArrays = arrays;
+  std::sort(data->sortedArrays.begin(), data->sortedArrays.end());
+  data->addrs = addrs;
+  data->acs = acs;
+  table.insert(data);
+  return RebaseID(data);
+}
+
+void RebaseID::clearTable() {
+  RebaseIDTable &table = getRebaseIDTable();
+  for (const RebaseIDData *data : table) {
+    delete data;
+  }
+  table.clear();
+  getArraySets().clear();
+}
+
 void RebaseID::dump() const {
   errs() << "RID: " << "\n";
-  errs() << "- Instruction: " << info->id << "\n";
-  errs() << "- Size: " << size << "\n";
+  errs() << "- Instruction: " << getInfo()->id << "\n";
+  errs() << "- Size: " << getSize() << "\n";
   errs() << "- Arrays: [ ";
-  for (uint64_t a : arrays) {
+  for (uint64_t a : getArrays()) {
     errs() << a << " ";
   }
   errs() << "]\n";
   errs() << "- Addresses: [ ";
-  for (uint64_t a : addrs) {
+  for (uint64_t a : getAddresses()) {
     errs() << a << " ";
   }
   errs() << "]\n";
@@ -104,64 +218,94 @@ void RebaseID::dump() const {
 
 RebaseCache *RebaseCache::instance = nullptr;
 
+void RebaseCache::destroy() {
+  delete instance;
+  instance = nullptr;
+  RebaseID::clearTable();
+}
+
+RebaseInfo *RebaseCache::lookup(const RebaseID &rid) {
+  auto i = index.find(rid);
+  if (i == index.end()) {
+    return nullptr;
+  }
+  return &rebased[i->second];
+}
+
+void RebaseCache::add(const RebaseInfo &info) {
+  assert(index.find(info.rid) == index.end());
+  index[info.rid] = rebased.size();
+  rebased.push_back(info);
+}
+
 UpdateList RebaseCache::find(const ExecutionState &state, ObjectState *os, const UpdateList &ul) {
   /* get dependent arrays */
   std::set<const Array *> arrays;
   os->getArrays(arrays);
 
-  /* generate array ID's */
+  /* generate array ID's (sorted, for the intersection) */
   Arrays ids;
   for (const Array *array : arrays) {
     ids.push_back(array->id);
   }
+  std::sort(ids.begin(), ids.end());
 
   const ExecutionState::History &h = state.getHistory();
   for (auto i = h.rbegin(); i != h.rend(); i++) {
     const RebaseID &rid = *i;
-    for (RebaseInfo &ri : rebased) {
-      if (ri.rid != rid) {
-        continue;
-      }
+    RebaseInfo *ri = lookup(rid);
+    if (!ri) {
+      continue;
+    }
 
-      std::vector<uint64_t> intersection;
-      set_intersection(rid.arrays.begin(),
-                       rid.arrays.end(),
-                       ids.begin(),
-                       ids.end(),
-                       std::inserter(intersection, intersection.begin()));
-      if (intersection.empty()) {
-        continue;
-      }
+    std::vector<uint64_t> intersection;
+    set_intersection(rid.getSortedArrays().begin(),
+                     rid.getSortedArrays().end(),
+                     ids.begin(),
+                     ids.end(),
+                     std::inserter(intersection, intersection.begin()));
+    if (intersection.empty()) {
+      continue;
+    }
 
-      UpdateList updates(nullptr, nullptr);
+    UpdateList updates(nullptr, nullptr);
 
-      auto i = ri.arrays.find(os->object->address);
-      if (i == ri.arrays.end()) {
-        updates = state.rewriteUL(ul, nullptr);
-        ri.arrays.insert(std::make_pair(os->object->address, updates.root));
-      } else {
-        updates = state.rewriteUL(ul, i->second);
-      }
-      return updates;
+    ArrayHolder *cached = ri->arrays.find(os->object->address);
+    if (!cached) {
+      ++stats::rewriteCacheMisses;
+      updates = state.rewriteUL(ul, nullptr);
+      stats::rewriteCacheEvictions +=
+          ri->arrays.insert(os->object->address, updates.root);
+    } else {
+      ++stats::rewriteCacheHits;
+      updates = state.rewriteUL(ul, cached->get());
     }
+    return updates;
   }
 
-  auto i = unrebased.find(os->object->address);
-  if (i == unrebased.end()) {
+  ArrayHolder *cached = unrebased.find(os->object->address);
+  if (!cached) {
+    ++stats::rewriteCacheMisses;
     UpdateList updates = state.rewriteUL(ul, NULL);
-    unrebased.insert(std::make_pair(os->object->address, updates.root));
+    stats::rewriteCacheEvictions +=
+        unrebased.insert(os->object->address, updates.root);
     return updates;
   } else {
-    return state.rewriteUL(ul, i->second);
+    ++stats::rewriteCacheHits;
+    return state.rewriteUL(ul, cached->get());
   }
 }
 
 /***/
 
-std::map<const Array *, const Array *> ExecutionState::globalRewriteCache;
+LRUCache<ArrayHolder, ArrayHolder> ExecutionState::globalRewriteCache;
 
 uint64_t ExecutionState::globalArrayID = 0;
 
+size_t ExecutionState::parkedBytes = 0;
+
+size_t ExecutionState::parkedBytesSaved = 0;
+
 ExecutionState::ExecutionState(KFunction *kf, MemoryManager *memory) :
     memory(memory),
     arrayID(0),
@@ -176,13 +320,18 @@ ExecutionState::ExecutionState(KFunction *kf, MemoryManager *memory) :
     forkDisabled(false),
     ptreeNode(0),
     steppedInstructions(0),
-    local_next_slot(0) {
+    splitObjects(0),
+    wasParked(false) {
   pushFrame(0, kf);
+  /* the bound is known only after the command line is parsed */
+  stats::rewriteCacheEvictions +=
+      globalRewriteCache.setCapacity(MaxRewriteCacheSize);
 }
 
 /* TODO: add rewritten constraints? */
 ExecutionState::ExecutionState(const std::vector<ref<Expr> > &assumptions)
-    : arrayID(0), constraints(assumptions), ptreeNode(0), local_next_slot(0) {}
+    : arrayID(0), constraints(assumptions), ptreeNode(0), splitObjects(0),
+      wasParked(false) {}
 
 ExecutionState::~ExecutionState() {
   for (unsigned int i=0; i<symbolics.size(); i++)
@@ -235,7 +384,10 @@ ExecutionState::ExecutionState(const ExecutionState& state):
     openMergeStack(state.openMergeStack),
     steppedInstructions(state.steppedInstructions),
     rewrittenConstraints(state.rewrittenConstraints),
-    local_next_slot(state.local_next_slot)
+    localSpace(state.localSpace),
+    profiledSegments(state.profiledSegments),
+    splitObjects(state.splitObjects),
+    wasParked(false)
 {
   for (unsigned int i=0; i<symbolics.size(); i++)
     symbolics[i].first->refCount++;
@@ -258,7 +410,7 @@ ExecutionState *ExecutionState::branch() {
 }
 
 void ExecutionState::pushFrame(KInstIterator caller, KFunction *kf) {
-  stack.push_back(StackFrame(caller,kf));
+  stack.emplace_back(caller, kf);
 }
 
 void ExecutionState::popFrame() {
@@ -272,6 +424,9 @@ void ExecutionState::popFrame() {
       }
     }
     unbindObject(mo);
+    if (mo->parent) {
+      mo->parent->markFreedLocal(mo, &localSpace);
+    }
   }
   stack.pop_back();
 }
@@ -324,10 +479,7 @@ llvm::raw_ostream &klee::operator<<(llvm::raw_ostream &os, const MemoryMap &mm)
   return os;
 }
 
-bool ExecutionState::merge(const ExecutionState &b) {
-  if (DebugLogStateMerge)
-    llvm::errs() << "-- attempting merge of A:" << this << " with B:" << &b
-                 << "--\n";
+bool ExecutionState::canMerge(const ExecutionState &b) const {
   if (pc != b.pc)
     return false;
 
@@ -350,6 +502,53 @@ bool ExecutionState::merge(const ExecutionState &b) {
       return false;
   }
 
+  // We cannot merge if addresses would resolve differently in the
+  // states. This means:
+  // 
+  // 1. Any objects created since the branch in either object must
+  // have been free'd.
+  //
+  // 2. We cannot have free'd any pre-existing object in one state
+  // and not the other
+
+  if (DebugLogStateMerge) {
+    llvm::errs() << "\tchecking object states\n";
+    llvm::errs() << "A: " << addressSpace.objects << "\n";
+    llvm::errs() << "B: " << b.addressSpace.objects << "\n";
+  }
+
+  MemoryMap::iterator ai = addressSpace.objects.begin();
+  MemoryMap::iterator bi = b.addressSpace.objects.begin();
+  MemoryMap::iterator ae = addressSpace.objects.end();
+  MemoryMap::iterator be = b.addressSpace.objects.end();
+  for (; ai!=ae && bi!=be; ++ai, ++bi) {
+    if (ai->first != bi->first) {
+      if (DebugLogStateMerge) {
+        if (ai->first < bi->first) {
+          llvm::errs() << "\t\tB misses binding for: " << ai->first->id << "\n";
+        } else {
+          llvm::errs() << "\t\tA misses binding for: " << bi->first->id << "\n";
+        }
+      }
+      return false;
+    }
+  }
+  if (ai!=ae || bi!=be) {
+    if (DebugLogStateMerge)
+      llvm::errs() << "\t\tmappings differ\n";
+    return false;
+  }
+
+  return true;
+}
+
+bool ExecutionState::merge(const ExecutionState &b) {
+  if (DebugLogStateMerge)
+    llvm::errs() << "-- attempting merge of A:" << this << " with B:" << &b
+                 << "--\n";
+  if (!canMerge(b))
+    return false;
+
   std::set< ref<Expr> > aConstraints(constraints.begin(), constraints.end());
   std::set< ref<Expr> > bConstraints(b.constraints.begin(), 
                                      b.constraints.end());
@@ -384,48 +583,17 @@ bool ExecutionState::merge(const ExecutionState &b) {
     llvm::errs() << "]\n";
   }
 
-  // We cannot merge if addresses would resolve differently in the
-  // states. This means:
-  // 
-  // 1. Any objects created since the branch in either object must
-  // have been free'd.
-  //
-  // 2. We cannot have free'd any pre-existing object in one state
-  // and not the other
-
-  if (DebugLogStateMerge) {
-    llvm::errs() << "\tchecking object states\n";
-    llvm::errs() << "A: " << addressSpace.objects << "\n";
-    llvm::errs() << "B: " << b.addressSpace.objects << "\n";
-  }
-    
   std::set<const MemoryObject*> mutated;
   MemoryMap::iterator ai = addressSpace.objects.begin();
   MemoryMap::iterator bi = b.addressSpace.objects.begin();
   MemoryMap::iterator ae = addressSpace.objects.end();
-  MemoryMap::iterator be = b.addressSpace.objects.end();
-  for (; ai!=ae && bi!=be; ++ai, ++bi) {
-    if (ai->first != bi->first) {
-      if (DebugLogStateMerge) {
-        if (ai->first < bi->first) {
-          llvm::errs() << "\t\tB misses binding for: " << ai->first->id << "\n";
-        } else {
-          llvm::errs() << "\t\tA misses binding for: " << bi->first->id << "\n";
-        }
-      }
-      return false;
-    }
+  for (; ai!=ae; ++ai, ++bi) {
     if (ai->second != bi->second) {
       if (DebugLogStateMerge)
         llvm::errs() << "\t\tmutated: " << ai->first->id << "\n";
       mutated.insert(ai->first);
     }
   }
-  if (ai!=ae || bi!=be) {
-    if (DebugLogStateMerge)
-      llvm::errs() << "\t\tmappings differ\n";
-    return false;
-  }
   
   // merge stack
 
@@ -448,13 +616,14 @@ bool ExecutionState::merge(const ExecutionState &b) {
     StackFrame &af = *itA;
     const StackFrame &bf = *itB;
     for (unsigned i=0; i<af.kf->numRegisters; i++) {
-      ref<Expr> &av = af.locals[i].value;
-      const ref<Expr> &bv = bf.locals[i].value;
+      Cell &ac = af.locals.getMutable(i);
+      ref<Expr> av = ac.materialize();
+      const ref<Expr> &bv = bf.locals[i].materialize();
       if (av.isNull() || bv.isNull()) {
         // if one is null then by implication (we are at same pc)
         // we cannot reuse this local, so just ignore
       } else {
-        av = SelectExpr::create(inA, av, bv);
+        ac.set(SelectExpr::create(inA, av, bv));
       }
     }
   }
@@ -510,7 +679,8 @@ void ExecutionState::dumpStack(llvm::raw_ostream &out) const {
 
       out << ai->getName().str();
       // XXX should go through function
-      ref<Expr> value = sf.locals[sf.kf->getArgRegister(index++)].value;
+      ref<Expr> value =
+          sf.locals[sf.kf->getArgRegister(index++)].materialize();
       if (value.get() && isa<ConstantExpr>(value))
         out << "=" << value;
     }
@@ -564,6 +734,46 @@ ref<AddressRecord> ExecutionState::getAddressConstraint(uint64_t id) const {
   }
 }
 
+void ExecutionState::park(ParkBase &base) {
+  assert(!parked && "state is already parked");
+  parked.reset(new Parked());
+
+  ConstraintManager::constraints_ty cs, rcs;
+  constraints.swap(cs);
+  rewrittenConstraints.swap(rcs);
+
+  std::pair<size_t, size_t> c = parked->constraints.park(cs, base.constraints);
+  std::pair<size_t, size_t> r =
+      parked->rewrittenConstraints.park(rcs, base.rewrittenConstraints);
+  std::pair<size_t, size_t> h = parked->history.park(history, base.history);
+
+  size_t before = c.first + r.first + h.first;
+  size_t after = c.second + r.second + h.second;
+  parked->bytes = after;
+  parked->saved = before > after ? before - after : 0;
+  parkedBytes += parked->bytes;
+  parkedBytesSaved += parked->saved;
+  if (!wasParked) {
+    wasParked = true;
+    ++stats::parkedStates;
+  }
+}
+
+void ExecutionState::unpark() {
+  if (!parked)
+    return;
+
+  ConstraintManager::constraints_ty cs, rcs;
+  parked->constraints.unpark(cs);
+  parked->rewrittenConstraints.unpark(rcs);
+  parked->history.unpark(history);
+  constraints.swap(cs);
+  rewrittenConstraints.swap(rcs);
+  parkedBytes -= parked->bytes;
+  parkedBytesSaved -= parked->saved;
+  parked.reset();
+}
+
 void ExecutionState::removeAddressConstraint(uint64_t id) {
   auto i = addressConstraints.find(id);
   if (i == addressConstraints.end()) {
@@ -630,6 +840,8 @@ ref<Expr> ExecutionState::unfold(const ref<Expr> address) const {
     return address;
   }
 
+  TimerStatIncrementer timer(stats::unfoldTime);
+
   /* a common case where the address is just (A) */
   if (isa<ConcatExpr>(address)) {
     ConcatExpr *concat = dyn_cast<ConcatExpr>(address);
@@ -686,6 +898,8 @@ ref<Expr> ExecutionState::unfold(const ref<Expr> address) const {
 }
 
 UpdateList ExecutionState::rewriteUL(const UpdateList &ul, const Array *array) const {
+  TimerStatIncrementer timer(stats::rewriteTime);
+
   struct WriteUpdate {
     ref<Expr> index;
     ref<Expr> value;
@@ -716,7 +930,9 @@ UpdateList ExecutionState::rewriteUL(const UpdateList &ul, const Array *array) c
   for (WriteUpdate &u : writes) {
     ref<Expr> index = u.index;
     ref<Expr> value = u.value;
-    if (canSetConstants && isa<ConstantExpr>(index)) {
+    /* an update of several elements is kept as it is */
+    if (canSetConstants && isa<ConstantExpr>(index) &&
+        value->getWidth() == ul.root->getRange()) {
       uint64_t offset = dyn_cast<ConstantExpr>(index)->getZExtValue();
       if (isa<ConstantExpr>(value)) {
         constants[offset] = dyn_cast<ConstantExpr>(value);
@@ -763,6 +979,8 @@ UpdateList ExecutionState::rewriteUL(const UpdateList &ul, const Array *array) c
                                     ul.root->size,
                                     &constants[0],
                                     &constants[0] + constants.size());
+    /* freed once no expression or cache refers to it any more */
+    arrayCache->release(array);
     klee_message("new array: %s (from %s)",
                  array->getName().data(),
                  ul.root->getName().data());
@@ -911,18 +1129,20 @@ uint64_t ExecutionState::allocateArrayID() {
 
 const Array *ExecutionState::getRewrittenArray(const Array *array) const {
   if (UseGlobalRewriteCache) {
-    auto i = globalRewriteCache.find(array);
-    if (i == globalRewriteCache.end()) {
+    ArrayHolder *cached = globalRewriteCache.find(array);
+    if (!cached) {
+      ++stats::rewriteCacheMisses;
       return nullptr;
     } else {
-      return i->second;
+      ++stats::rewriteCacheHits;
+      return cached->get();
     }
   } else {
     auto i = rewriteCache.find(array);
     if (i == rewriteCache.end()) {
       return nullptr;
     } else {
-      return i->second;
+      return i->second.get();
     }
   }
 }
@@ -930,7 +1150,7 @@ const Array *ExecutionState::getRewrittenArray(const Array *array) const {
 void ExecutionState::updateRewrittenArray(const Array *array,
                                           const Array *rewritten) {
   if (UseGlobalRewriteCache) {
-    globalRewriteCache[array] = rewritten;
+    stats::rewriteCacheEvictions += globalRewriteCache.insert(array, rewritten);
   } else {
     rewriteCache[array] = rewritten;
   }
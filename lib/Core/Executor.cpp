@@ -20,6 +20,7 @@
 #include "PTree.h"
 #include "Searcher.h"
 #include "SeedInfo.h"
+#include "SolverTrace.h"
 #include "SpecialFunctionHandler.h"
 #include "StatsTracker.h"
 #include "TimingSolver.h"
@@ -153,6 +154,13 @@ cl::opt<bool>
                                   "querying the solver (default=true)"),
                          cl::cat(SolvingCat));
 
+cl::opt<bool>
+    TraceSolverQueries("solver-trace", cl::init(false),
+                       cl::desc("Write a binary record of every solver query "
+                                "to solver-trace.bin, see klee-solver-trace "
+                                "(default=false)"),
+                       cl::cat(SolvingCat));
+
 
 /*** External call policy options ***/
 
@@ -248,6 +256,15 @@ cl::opt<std::string>
                       "search (default=0s (off))"),
              cl::cat(SeedingCat));
 
+cl::opt<bool> ConcolicSeeds(
+    "concolic-seeds",
+    cl::init(false),
+    cl::desc("Follow the seeds at symbolic branches by evaluating the "
+             "conditions on them instead of calling the solver. The solver is "
+             "only used the first time a branch direction is not taken by "
+             "any seed, to fork off an unseeded state (default=false)."),
+    cl::cat(SeedingCat));
+
 
 /*** Termination criteria options ***/
 
@@ -423,6 +440,43 @@ cl::opt<unsigned> PartitionSize("partition-size", cl::init(128), cl::desc("...")
 cl::opt<bool> SplitObjects("split-objects", cl::init(false), cl::desc("..."));
 
 cl::opt<unsigned> SplitThreshold("split-threshold", cl::init(128), cl::desc("..."));
+
+cl::opt<unsigned> MergeSplitInterval(
+    "merge-split-interval", cl::init(10000),
+    cl::desc("Every this many instructions of a state, merge back the split "
+             "objects that no symbolic pointer in a register may point to "
+             "(0=off, default=10000)"));
+
+cl::opt<bool> PartitionByAccess(
+    "partition-by-access", cl::init(true),
+    cl::desc("When splitting an object, keep the offset windows observed in "
+             "symbolic accesses in one part, and use --partition-size only "
+             "for the rest (default=true)"));
+
+cl::opt<unsigned> PartitionMinAccesses(
+    "partition-min-accesses", cl::init(2),
+    cl::desc("With --partition-by-access, the number of symbolic accesses "
+             "after which an offset window is kept in one part (default=2)"));
+
+cl::opt<std::string> ResolveProfilePath(
+    "resolve-profile", cl::init(""),
+    cl::desc("Load resolution sets and rebase outcomes recorded by a previous "
+             "run (see --write-resolve-profile)"));
+
+cl::opt<bool> WriteResolveProfile(
+    "write-resolve-profile", cl::init(false),
+    cl::desc("Write resolution sets and rebase outcomes to resolve.profile in "
+             "the output directory (default=false)"));
+
+cl::opt<unsigned> ProfiledSegmentSize(
+    "profiled-segment-size", cl::init(4096),
+    cl::desc("Size of the shared segments used for allocation contexts which "
+             "were merged in a previous run (default=4096)"));
+
+cl::opt<unsigned> RNGInitialSeed(
+    "rng-initial-seed", cl::init(5489U),
+    cl::desc("Initial seed of the random number generator used by the "
+             "searchers (default=5489)"));
 } // namespace
 
 namespace klee {
@@ -452,8 +506,10 @@ Executor::Executor(LLVMContext &ctx, const InterpreterOptions &opts,
       pathWriter(0), symPathWriter(0), specialFunctionHandler(0),
       processTree(0), replayKTest(0), replayPath(0), usingSeeds(0),
       atMemoryLimit(false), inhibitForking(false), haltExecution(false),
-      ivcEnabled(false), debugLogBuffer(debugBufferString) {
+      ivcEnabled(false), debugLogBuffer(debugBufferString),
+      addressArrays(&arrayCache) {
 
+  theRNG.seed(RNGInitialSeed);
 
   const time::Span maxCoreSolverTime(MaxCoreSolverTime);
   maxInstructionTime = time::Span(MaxInstructionTime);
@@ -475,8 +531,15 @@ Executor::Executor(LLVMContext &ctx, const InterpreterOptions &opts,
       interpreterHandler->getOutputFilename(SOLVER_QUERIES_KQUERY_FILE_NAME));
 
   this->solver = new TimingSolver(solver, EqualitySubstitution);
+  if (TraceSolverQueries) {
+    if (auto f = interpreterHandler->openOutputFile("solver-trace.bin"))
+      this->solver->setTrace(std::unique_ptr<SolverTrace>(
+          new SolverTrace(std::move(f))));
+  }
   memory = new MemoryManager(&arrayCache);
   addressMemory = new MemoryManager(&arrayCache);
+  /* the access windows are only needed to partition split objects */
+  ObjectState::recordAccesses = SplitObjects && PartitionByAccess;
 
   initializeSearchOptions();
 
@@ -504,6 +567,20 @@ Executor::Executor(LLVMContext &ctx, const InterpreterOptions &opts,
                  error.c_str());
     }
   }
+
+  if (!ResolveProfilePath.empty()) {
+    std::string error;
+    if (!loadedProfile.load(ResolveProfilePath, error)) {
+      klee_error("Could not load resolve profile %s : %s",
+                 ResolveProfilePath.c_str(), error.c_str());
+    }
+    /* seed the context resolution with the recorded resolution sets */
+    resolveCache = loadedProfile.resolved;
+    /* the rebases the loaded groups avoid are kept in the written profile */
+    if (WriteResolveProfile) {
+      recordedProfile = loadedProfile;
+    }
+  }
 }
 
 llvm::Module *
@@ -570,6 +647,7 @@ Executor::setModule(std::vector<std::unique_ptr<llvm::Module>> &modules,
 }
 
 Executor::~Executor() {
+  RebaseCache::destroy();
   delete memory;
   delete addressMemory;
   delete externalDispatcher;
@@ -751,7 +829,7 @@ void Executor::initializeGlobals(ExecutionState &state) {
       MemoryObject *mo = memory->allocate(size, /*isLocal=*/false,
                                           /*isGlobal=*/true, /*allocSite=*/v,
                                           /*alignment=*/globalObjectAlignment,
-                                          &state.local_next_slot);
+                                          &state.localSpace);
       ObjectState *os = bindObjectInState(state, mo, false);
       globalObjects.insert(std::make_pair(v, mo));
       /* TODO: ... */
@@ -783,7 +861,7 @@ void Executor::initializeGlobals(ExecutionState &state) {
       MemoryObject *mo = memory->allocate(size, /*isLocal=*/false,
                                           /*isGlobal=*/true, /*allocSite=*/v,
                                           /*alignment=*/globalObjectAlignment,
-                                          &state.local_next_slot);
+                                          &state.localSpace);
       if (!mo)
         llvm::report_fatal_error("out of memory");
       ObjectState *os = bindObjectInState(state, mo, false);
@@ -957,7 +1035,11 @@ Executor::fork(ExecutionState &current, ref<Expr> condition, bool isInternal) {
   if (isSeeding)
     timeout *= static_cast<unsigned>(it->second.size());
   solver->setTimeout(timeout);
-  bool success = solver->evaluate(current, condition, res);
+  bool success;
+  if (isSeeding && ConcolicSeeds)
+    success = concolicEvaluate(current, condition, it->second, res);
+  else
+    success = solver->evaluate(current, condition, res);
   solver->setTimeout(time::Span());
   if (!success) {
     current.pc = current.prevPC;
@@ -1148,6 +1230,50 @@ Executor::fork(ExecutionState &current, ref<Expr> condition, bool isInternal) {
   }
 }
 
+bool Executor::concolicEvaluate(ExecutionState &state, ref<Expr> condition,
+                                std::vector<SeedInfo> &seeds,
+                                Solver::Validity &res) {
+  if (isa<ConstantExpr>(condition) || seeds.empty())
+    return solver->evaluate(state, condition, res);
+
+  bool trueSeed = false, falseSeed = false;
+  for (auto &si : seeds) {
+    ref<Expr> value = si.assignment.evaluate(condition);
+    ConstantExpr *CE = dyn_cast<ConstantExpr>(value);
+    if (!CE)
+      return solver->evaluate(state, condition, res);
+    if (CE->isTrue())
+      trueSeed = true;
+    else
+      falseSeed = true;
+  }
+
+  // Each side has a seed that satisfies it, so both are feasible.
+  if (trueSeed && falseSeed) {
+    res = Solver::Unknown;
+    return true;
+  }
+
+  ref<Expr> taken = trueSeed ? condition : Expr::createIsZero(condition);
+  if (!OnlyReplaySeeds && !state.forkDisabled && !inhibitForking &&
+      concolicNegated.insert(std::make_pair(state.prevPC, !trueSeed)).second) {
+    bool mayBeNegated;
+    if (!solver->mayBeFalse(state, taken, mayBeNegated))
+      return false;
+    if (mayBeNegated) {
+      // fork() leaves the seedless side out of the seed map
+      res = Solver::Unknown;
+      return true;
+    }
+  }
+
+  // The seeds satisfy the taken side, record it as a path constraint
+  // without asking the solver whether it was already implied.
+  addConstraint(state, taken);
+  res = trueSeed ? Solver::True : Solver::False;
+  return true;
+}
+
 void Executor::addConstraint(ExecutionState &state, ref<Expr> condition) {
   if (ConstantExpr *CE = dyn_cast<ConstantExpr>(condition)) {
     if (!CE->isTrue())
@@ -1197,18 +1323,78 @@ const Cell& Executor::eval(KInstruction *ki, unsigned index,
   } else {
     unsigned index = vnumber;
     StackFrame &sf = state.stack.back();
-    return sf.locals[index];
+    const Cell &c = sf.locals[index];
+    c.materialize();
+    return c;
+  }
+}
+
+static bool getConcrete(const Cell &c, uint64_t &value, Expr::Width &width) {
+  if (c.isConcrete()) {
+    value = c.concrete;
+    width = c.width;
+    return true;
+  }
+  if (c.value.isNull())
+    return false;
+  if (klee::ConstantExpr *ce = dyn_cast<klee::ConstantExpr>(c.value)) {
+    if (ce->getWidth() <= 64) {
+      value = ce->getZExtValue();
+      width = ce->getWidth();
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Executor::evalConcrete(KInstruction *ki, unsigned index,
+                            ExecutionState &state, uint64_t &value,
+                            Expr::Width &width) const {
+  int vnumber = ki->operands[index];
+  const Cell &c = vnumber < 0 ? kmodule->constantTable[-vnumber - 2]
+                              : state.stack.back().locals[vnumber];
+  return getConcrete(c, value, width);
+}
+
+bool Executor::evalConcrete(const KOperand &slot, ExecutionState &state,
+                            uint64_t &value, Expr::Width &width) const {
+  switch (slot.kind) {
+  case KOperand::Inline:
+    value = slot.value;
+    width = slot.width;
+    return true;
+  case KOperand::Constant:
+    return getConcrete(kmodule->constantTable[slot.value], value, width);
+  default:
+    return getConcrete(state.stack.back().locals[slot.value], value, width);
+  }
+}
+
+ref<Expr> Executor::evalOperand(const KOperand &slot,
+                                ExecutionState &state) const {
+  switch (slot.kind) {
+  case KOperand::Inline:
+    return ConstantExpr::create(slot.value, slot.width);
+  case KOperand::Constant:
+    return kmodule->constantTable[slot.value].value;
+  default:
+    return state.stack.back().locals[slot.value].materialize();
   }
 }
 
 void Executor::bindLocal(KInstruction *target, ExecutionState &state, 
                          ref<Expr> value) {
-  getDestCell(state, target).value = value;
+  getDestCell(state, target).set(value);
+}
+
+void Executor::bindLocalConcrete(KInstruction *target, ExecutionState &state,
+                                 uint64_t value, Expr::Width width) {
+  getDestCell(state, target).setConcrete(value, width);
 }
 
 void Executor::bindArgument(KFunction *kf, unsigned index, 
                             ExecutionState &state, ref<Expr> value) {
-  getArgumentCell(state, kf, index).value = value;
+  getArgumentCell(state, kf, index).set(value);
 }
 
 ref<Expr> Executor::toUnique(const ExecutionState &state, 
@@ -1353,6 +1539,10 @@ void Executor::stepInstruction(ExecutionState &state) {
   state.prevPC = state.pc;
   ++state.pc;
 
+  if (MergeSplitInterval && state.splitObjects &&
+      state.steppedInstructions % MergeSplitInterval == 0)
+    mergeSplitObjects(state);
+
   if (stats::instructions == MaxInstructions)
     haltExecution = true;
 }
@@ -1505,7 +1695,7 @@ void Executor::executeCall(ExecutionState &state,
       MemoryObject *mo = sf.varargs =
           memory->allocate(size, true, false, state.prevPC->inst,
                            (requires16ByteAlignment ? 16 : 8),
-                           &state.local_next_slot);
+                           &state.localSpace);
       if (!mo && size) {
         terminateStateOnExecError(state, "out of memory (varargs)");
         return;
@@ -2750,6 +2940,193 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   }
 }
 
+namespace {
+  inline uint64_t truncateTo(uint64_t value, Expr::Width width) {
+    return width == 64 ? value : value & ((1ULL << width) - 1);
+  }
+
+  inline int64_t signExtendFrom(uint64_t value, Expr::Width width) {
+    return (int64_t) (value << (64 - width)) >> (64 - width);
+  }
+
+  // Operations of the pre-decoded handlers. evaluate computes the result
+  // on inline concrete operands and returns false for the cases it does
+  // not handle, which then go through create.
+#define BINARY_OP(_op, _result)                                                \
+  struct _op##Op {                                                             \
+    static ref<Expr> create(const ref<Expr> &l, const ref<Expr> &r) {          \
+      return _op##Expr::create(l, r);                                          \
+    }                                                                          \
+    static bool evaluate(uint64_t l, uint64_t r, Expr::Width w,                \
+                         uint64_t &result) {                                   \
+      (void) w;                                                                \
+      _result;                                                                 \
+      return true;                                                             \
+    }                                                                          \
+  };
+
+#define CMP_OP(_op, _cond) BINARY_OP(_op, result = (_cond) ? 1 : 0)
+
+  BINARY_OP(Add, result = truncateTo(l + r, w))
+  BINARY_OP(Sub, result = truncateTo(l - r, w))
+  BINARY_OP(Mul, result = truncateTo(l * r, w))
+  BINARY_OP(And, result = l & r)
+  BINARY_OP(Or, result = l | r)
+  BINARY_OP(Xor, result = l ^ r)
+  // oversized shifts are left to the expression semantics
+  BINARY_OP(Shl, if (r >= w) return false; result = truncateTo(l << r, w))
+  BINARY_OP(LShr, if (r >= w) return false; result = l >> r)
+  BINARY_OP(AShr, if (r >= w) return false;
+            result = truncateTo(signExtendFrom(l, w) >> r, w))
+  CMP_OP(Eq, l == r)
+  CMP_OP(Ne, l != r)
+  CMP_OP(Ugt, l > r)
+  CMP_OP(Uge, l >= r)
+  CMP_OP(Ult, l < r)
+  CMP_OP(Ule, l <= r)
+  CMP_OP(Sgt, signExtendFrom(l, w) > signExtendFrom(r, w))
+  CMP_OP(Sge, signExtendFrom(l, w) >= signExtendFrom(r, w))
+  CMP_OP(Slt, signExtendFrom(l, w) < signExtendFrom(r, w))
+  CMP_OP(Sle, signExtendFrom(l, w) <= signExtendFrom(r, w))
+#undef CMP_OP
+#undef BINARY_OP
+
+  template <typename Op> struct ResultWidth {
+    static Expr::Width get(Expr::Width w) { return w; }
+  };
+
+#define CMP_WIDTH(_op)                                                         \
+  template <> struct ResultWidth<_op##Op> {                                    \
+    static Expr::Width get(Expr::Width) { return Expr::Bool; }                 \
+  };
+  CMP_WIDTH(Eq)
+  CMP_WIDTH(Ne)
+  CMP_WIDTH(Ugt)
+  CMP_WIDTH(Uge)
+  CMP_WIDTH(Ult)
+  CMP_WIDTH(Ule)
+  CMP_WIDTH(Sgt)
+  CMP_WIDTH(Sge)
+  CMP_WIDTH(Slt)
+  CMP_WIDTH(Sle)
+#undef CMP_WIDTH
+
+  struct TruncOp {
+    static ref<Expr> create(const ref<Expr> &e, Expr::Width w) {
+      return ExtractExpr::create(e, 0, w);
+    }
+    static uint64_t evaluate(uint64_t v, Expr::Width, Expr::Width w) {
+      return truncateTo(v, w);
+    }
+  };
+
+  struct ZExtOp {
+    static ref<Expr> create(const ref<Expr> &e, Expr::Width w) {
+      return ZExtExpr::create(e, w);
+    }
+    static uint64_t evaluate(uint64_t v, Expr::Width, Expr::Width) {
+      return v;
+    }
+  };
+
+  struct SExtOp {
+    static ref<Expr> create(const ref<Expr> &e, Expr::Width w) {
+      return SExtExpr::create(e, w);
+    }
+    static uint64_t evaluate(uint64_t v, Expr::Width from, Expr::Width w) {
+      return truncateTo(signExtendFrom(v, from), w);
+    }
+  };
+}
+
+template <typename Op>
+void Executor::executeBinary(ExecutionState &state, KInstruction *ki) {
+  uint64_t left, right, result;
+  Expr::Width width, rightWidth;
+  if (evalConcrete(ki->slots[0], state, left, width) &&
+      evalConcrete(ki->slots[1], state, right, rightWidth) &&
+      Op::evaluate(left, right, width, result)) {
+    bindLocalConcrete(ki, state, result, ResultWidth<Op>::get(width));
+    return;
+  }
+
+  bindLocal(ki, state, Op::create(evalOperand(ki->slots[0], state),
+                                  evalOperand(ki->slots[1], state)));
+}
+
+template <typename Op>
+void Executor::executeCast(ExecutionState &state, KInstruction *ki) {
+  uint64_t arg;
+  Expr::Width argWidth;
+  if (ki->width <= 64 && evalConcrete(ki->slots[0], state, arg, argWidth)) {
+    bindLocalConcrete(ki, state, Op::evaluate(arg, argWidth, ki->width),
+                      ki->width);
+    return;
+  }
+  bindLocal(ki, state, Op::create(evalOperand(ki->slots[0], state), ki->width));
+}
+
+void Executor::executeBitCast(ExecutionState &state, KInstruction *ki) {
+  uint64_t value;
+  Expr::Width width;
+  if (evalConcrete(ki->slots[0], state, value, width))
+    bindLocalConcrete(ki, state, value, width);
+  else
+    bindLocal(ki, state, evalOperand(ki->slots[0], state));
+}
+
+void Executor::executeBranch(ExecutionState &state, KInstruction *ki) {
+  // same as transferToBasicBlock, with the successor resolved up front
+  state.pc = &state.stack.back().kf->instructions[ki->successor];
+  if (ki->successorIncoming >= 0)
+    state.incomingBBIndex = ki->successorIncoming;
+}
+
+void Executor::executePHI(ExecutionState &state, KInstruction *ki) {
+  uint64_t value;
+  Expr::Width width;
+  if (evalConcrete(ki, state.incomingBBIndex, state, value, width))
+    bindLocalConcrete(ki, state, value, width);
+  else
+    bindLocal(ki, state, eval(ki, state.incomingBBIndex, state).value);
+}
+
+const Executor::InstructionHandler Executor::instructionHandlers[] = {
+    &Executor::executeInstruction,
+    &Executor::executeBinary<AddOp>,
+    &Executor::executeBinary<SubOp>,
+    &Executor::executeBinary<MulOp>,
+    &Executor::executeBinary<AndOp>,
+    &Executor::executeBinary<OrOp>,
+    &Executor::executeBinary<XorOp>,
+    &Executor::executeBinary<ShlOp>,
+    &Executor::executeBinary<LShrOp>,
+    &Executor::executeBinary<AShrOp>,
+    &Executor::executeBinary<EqOp>,
+    &Executor::executeBinary<NeOp>,
+    &Executor::executeBinary<UgtOp>,
+    &Executor::executeBinary<UgeOp>,
+    &Executor::executeBinary<UltOp>,
+    &Executor::executeBinary<UleOp>,
+    &Executor::executeBinary<SgtOp>,
+    &Executor::executeBinary<SgeOp>,
+    &Executor::executeBinary<SltOp>,
+    &Executor::executeBinary<SleOp>,
+    &Executor::executeCast<TruncOp>,
+    &Executor::executeCast<ZExtOp>,
+    &Executor::executeCast<SExtOp>,
+    &Executor::executeBitCast,
+    &Executor::executeBranch,
+    &Executor::executePHI,
+};
+
+void Executor::dispatchInstruction(ExecutionState &state, KInstruction *ki) {
+  static_assert(sizeof(instructionHandlers) / sizeof(instructionHandlers[0]) ==
+                    static_cast<unsigned>(KOpcode::NumOpcodes),
+                "one handler per KOpcode");
+  (this->*instructionHandlers[static_cast<unsigned>(ki->opcode)])(state, ki);
+}
+
 void Executor::updateStates(ExecutionState *current) {
   if (searcher) {
     searcher->update(current, addedStates, removedStates);
@@ -2854,6 +3231,12 @@ void Executor::bindModuleConstants() {
   for (unsigned i=0; i<kmodule->constants.size(); ++i) {
     Cell &c = kmodule->constantTable[i];
     c.value = evalConstant(kmodule->constants[i]);
+    // keep the value inline as well, for the concrete fast paths
+    if (ConstantExpr *ce = dyn_cast<ConstantExpr>(c.value))
+      if (ce->getWidth() <= 64) {
+        c.concrete = ce->getZExtValue();
+        c.width = ce->getWidth();
+      }
   }
 }
 
@@ -2937,7 +3320,7 @@ void Executor::run(ExecutionState &initialState) {
       KInstruction *ki = state.pc;
       stepInstruction(state);
 
-      executeInstruction(state, ki);
+      dispatchInstruction(state, ki);
       processTimers(&state, maxInstructionTime * numSeeds);
       updateStates(&state);
 
@@ -2991,7 +3374,7 @@ void Executor::run(ExecutionState &initialState) {
     KInstruction *ki = state.pc;
     stepInstruction(state);
 
-    executeInstruction(state, ki);
+    dispatchInstruction(state, ki);
     processTimers(&state, maxInstructionTime);
 
     checkMemoryUsage();
@@ -3107,6 +3490,8 @@ void Executor::terminateState(ExecutionState &state) {
 
 void Executor::terminateStateEarly(ExecutionState &state, 
                                    const Twine &message) {
+  // states waiting at a klee_close_merge are halted here while parked
+  state.unpark();
   if (!OnlyOutputStatesCoveringNew || state.coveredNew ||
       (AlwaysOutputSeeds && seedMap.count(&state)))
     interpreterHandler->processTestCase(state, (message + "\n").str().c_str(),
@@ -3432,9 +3817,19 @@ void Executor::executeAlloc(ExecutionState &state,
       allocationAlignment = getAllocationAlignment(allocSite);
     }
 
+    uint64_t group;
+    if (UseSymAddr && MergeObjects && !isLocal && !reallocFrom &&
+        loadedProfile.getGroup(state.getAC(), group)) {
+      /* merged with other objects in a previous run, avoid the rebase */
+      if (allocateInProfiledSegment(state, group, CE->getZExtValue(),
+                                    zeroMemory, target)) {
+        return;
+      }
+    }
+
     MemoryObject *mo =
         memory->allocate(CE->getZExtValue(), isLocal, /*isGlobal=*/false,
-                         allocSite, allocationAlignment, &state.local_next_slot);
+                         allocSite, allocationAlignment, &state.localSpace);
     mo->ac = state.getAC();
 
     if (!mo) {
@@ -3463,22 +3858,26 @@ void Executor::executeAlloc(ExecutionState &state,
         if (reallocFrom->isSplit) {
           count = reallocFrom->originalSize;
           klee_warning("realloc of split object (original size = %u)", count);
-          for (unsigned i=0; i<count; i++) {
+          count = std::min(count, os->size);
+          unsigned i = 0;
+          while (i < count) {
             uint64_t a = reallocFrom->getObject()->address + i;
-            ref<Expr> ae = ConstantExpr::create(reallocFrom->getObject()->address + i, Expr::Int64);
+            ref<Expr> ae = ConstantExpr::create(a, Expr::Int64);
             bool success;
             ObjectPair op;
             assert(state.addressSpace.resolveOne(state, solver, ae, op, success));
             assert(success);
 
+            /* copy the rest of the split object at once */
             const ObjectState *splitOS = op.second;
-            os->write(i, splitOS->read8(a - splitOS->getObject()->address));
+            unsigned splitOffset = a - splitOS->getObject()->address;
+            unsigned n = std::min(count - i, splitOS->size - splitOffset);
+            os->copyFrom(i, *splitOS, splitOffset, n);
+            i += n;
           }
         } else {
           count = std::min(reallocFrom->size, os->size);
-          for (unsigned i=0; i<count; i++) {
-            os->write(i, reallocFrom->read8(i));
-          }
+          os->copyFrom(0, *reallocFrom, 0, count);
         }
         state.unbindObject(reallocFrom->getObject());
       }
@@ -3597,6 +3996,7 @@ void Executor::executeFree(ExecutionState &state,
           continue;
         }
         it->second->unbindObject(mo);
+        memory->markFreedLocal(mo, &it->second->localSpace);
         if (target)
           bindLocal(target, *it->second, Expr::createPointer(0));
       }
@@ -3729,12 +4129,12 @@ void Executor::executeMemoryOperation(ExecutionState &state,
           wos->write(offset, value);
         }          
       } else {
-        ref<Expr> result = os->read(offset, type);
-        if (shouldSplit(state, mo, os, offset)) {
+        if (shouldSplit(state, mo, os, offset, type)) {
           splitMO(state, ObjectPair(mo, os));
           executeMemoryOperation(state, isWrite, originalAddress, value, target, false, false);
           return;
         } else {
+          ref<Expr> result = os->read(offset, type);
           if (interpreterOpts.MakeConcreteSymbolic)
             result = replaceReadWithSymbolic(state, result);
 
@@ -3821,7 +4221,7 @@ void Executor::executeMemoryOperation(ExecutionState &state,
         if (isa<ConstantExpr>(rewrittenOffset)) {
           offset = rewrittenOffset;
         }
-        if (shouldSplit(state, mo, os, offset)) {
+        if (shouldSplit(state, mo, os, offset, type)) {
           splitMO(*bound, ObjectPair(mo, os));
           executeMemoryOperation(*bound, isWrite, originalAddress, value, target, false, false);
         } else {
@@ -3964,7 +4364,7 @@ void Executor::runFunctionAsMain(Function *f,
       argvMO =
           memory->allocate((argc + 1 + envc + 1 + 1) * NumPtrBytes,
                            /*isLocal=*/false, /*isGlobal=*/true,
-                           /*allocSite=*/first, /*alignment=*/8, &state->local_next_slot);
+                           /*allocSite=*/first, /*alignment=*/8, &state->localSpace);
 
       if (!argvMO)
         klee_error("Could not allocate memory for function arguments");
@@ -4009,7 +4409,7 @@ void Executor::runFunctionAsMain(Function *f,
 
         MemoryObject *arg =
             memory->allocate(len + 1, /*isLocal=*/false, /*isGlobal=*/true,
-                             /*allocSite=*/state->pc->inst, /*alignment=*/8, &state->local_next_slot);
+                             /*allocSite=*/state->pc->inst, /*alignment=*/8, &state->localSpace);
         if (!arg)
           klee_error("Could not allocate memory for function arguments");
         ObjectState *os = bindObjectInState(*state, arg, false);
@@ -4045,6 +4445,9 @@ void Executor::runFunctionAsMain(Function *f,
   if (statsTracker)
     statsTracker->done();
 
+  if (WriteResolveProfile)
+    writeResolveProfile();
+
   klee_message("Arrays: %lu", arrayCache.getSymbolicArrays());
 
   double t = (double)(stats::resolveTime) / (double)(statsTracker->elapsed().toMicroseconds());
@@ -4263,32 +4666,92 @@ size_t Executor::getAllocationAlignment(const llvm::Value *allocSite) const {
 void Executor::symbolizeMO(ExecutionState &state,
                            const MemoryObject *mo,
                            SymbolicAddressInfo &info) {
+  symbolizeAddress(state, mo->address, info);
+  mo->sainfo = info;
+}
+
+void Executor::symbolizeAddress(ExecutionState &state,
+                                uint64_t address,
+                                SymbolicAddressInfo &info) {
   const Array *array = nullptr;
+  ref<Expr> alpha;
   do {
-    std::string uniqueName = "addr_" + llvm::utostr(state.allocateArrayID());
-    array = arrayCache.CreateArray(uniqueName, Context::get().getPointerWidth() / 8);
+    const AddressArrayPool::Entry &entry = addressArrays.get(state.allocateArrayID());
+    array = entry.array;
+    alpha = entry.alpha;
   } while (state.hasAddressConstraint(array->id));
 
-  ref<Expr> alpha;
-  auto i = addressExpresssions.find(array->id);
-  if (i == addressExpresssions.end()) {
-    ref<Expr> kids[8];
-    for (unsigned i = 0; i < 8; i++) {
-      kids[i] = ReadExpr::create(UpdateList(array, nullptr),
-                                 ConstantExpr::create(8 - i - 1, Expr::Int32));
-    }
-    alpha = ConcatExpr::createN(8, kids);
-    addressExpresssions[array->id] = alpha;
-  } else {
-    alpha = i->second;
-  }
-
-  state.addAddressConstraint(array->id, mo->address, alpha);
+  state.addAddressConstraint(array->id, address, alpha);
 
   info.address = alpha;
   info.arrayID = array->id;
+}
 
-  mo->sainfo = info;
+bool Executor::allocateInProfiledSegment(ExecutionState &state,
+                                         uint64_t group,
+                                         uint64_t size,
+                                         bool zeroMemory,
+                                         KInstruction *target) {
+  uint64_t alignedSize = getAlignedSize(size);
+  if (size == 0 || alignedSize > ProfiledSegmentSize) {
+    return false;
+  }
+
+  const MemoryObject *segmentMO = nullptr;
+  ObjectState *segmentOS = nullptr;
+
+  /* the segment may have been freed or rebased since it was created */
+  auto i = state.profiledSegments.find(group);
+  if (i != state.profiledSegments.end()) {
+    ObjectPair op;
+    ref<ConstantExpr> address = ConstantExpr::create(i->second, Expr::Int64);
+    if (state.addressSpace.resolveOne(address, op) &&
+        op.first->address == i->second && op.second->isSegment() &&
+        !op.second->readOnly) {
+      segmentMO = op.first;
+      segmentOS = state.addressSpace.getWriteable(segmentMO, op.second);
+    }
+  }
+
+  unsigned offset = segmentOS ? segmentOS->getEffectiveSize() : 0;
+  if (!segmentOS || offset + alignedSize > segmentOS->size) {
+    segmentMO = memory->allocate(ProfiledSegmentSize, false, false, nullptr, 8,
+                                 &state.localSpace);
+    if (!segmentMO) {
+      return false;
+    }
+    segmentOS = bindObjectInState(state, segmentMO, false);
+    /* objects are only appended, so their bytes are untouched until then */
+    segmentOS->initializeToRandom();
+    SymbolicAddressInfo info;
+    symbolizeMO(state, segmentMO, info);
+    segmentOS->addSubSegment(0, segmentOS->size, info);
+    state.profiledSegments[group] = segmentMO->address;
+    offset = 0;
+    klee_message("%p: creating profiled segment: %lu (group = %lu)",
+                 &state, segmentMO->address, group);
+  }
+
+  SymbolicAddressInfo info;
+  symbolizeAddress(state, segmentMO->address + offset, info);
+  segmentOS->addSubObject(offset, alignedSize, info);
+  if (zeroMemory) {
+    for (unsigned j = 0; j < size; j++) {
+      segmentOS->write8(offset + j, 0);
+    }
+  }
+
+  bindLocal(target, state, info.address);
+  return true;
+}
+
+void Executor::writeResolveProfile() {
+  auto os = interpreterHandler->openOutputFile("resolve.profile");
+  if (!os) {
+    klee_warning("unable to write resolve profile");
+    return;
+  }
+  recordedProfile.save(*os);
 }
 
 void Executor::rebaseObject(ExecutionState &state, ObjectPair &op) {
@@ -4298,6 +4761,8 @@ void Executor::rebaseObject(ExecutionState &state, ObjectPair &op) {
 
 /* TODO: remove code duplication */
 bool Executor::rebaseObjects(ExecutionState &state, std::vector<ObjectPair> ops) {
+  TimerStatIncrementer timer(stats::rebaseTime);
+
   if (SortObjects) {
     std::sort(
       ops.begin(),
@@ -4349,13 +4814,27 @@ bool Executor::rebaseObjects(ExecutionState &state, std::vector<ObjectPair> ops)
   }
 
   RebaseID rid = buildRebaseID(state, ops, total_size);
-  RebaseInfo ri;
 
-  bool seen = wasRebased(state, rid, ri);
-  if (ReuseSegments && seen) {
+  RebaseInfo *ri = wasRebased(state, rid);
+  bool seen = ri != nullptr;
+  if (seen) {
+    ++stats::rebaseCacheHits;
+  }
+  bool adopted = false;
+  if (ReuseSegments && seen && !segmentOS) {
+    adopted = adoptSegment(state, *ri, opsToRebase, offsets);
+    if (adopted) {
+      segmentMO = ri->mo;
+    }
+  }
+
+  if (adopted) {
+    klee_message("%p: adopted the segment of a previous rebase: %lu",
+                 &state, segmentMO->address);
+  } else if (ReuseSegments && seen) {
     klee_message("%p: was already rebased at %u", &state, state.prevPC->info->id);
 
-    segmentMO = memory->allocateFixed(ri.mo->address, ri.mo->size, nullptr);
+    segmentMO = memory->allocateFixed(ri->mo->address, ri->mo->size, nullptr);
 
     /* TODO: do we need these checks? */
     ref<ConstantExpr> address = ConstantExpr::create(segmentMO->address, Expr::Int64);
@@ -4367,7 +4846,7 @@ bool Executor::rebaseObjects(ExecutionState &state, std::vector<ObjectPair> ops)
       assert(0);
     }
 
-    ObjectState *os = ri.oh;
+    ObjectState *os = ri->oh;
     segmentOS = bindObjectInState(state, segmentMO, false, os->getArray());
     segmentOS->initializeToZero();
     assert(segmentOS->size == total_size);
@@ -4381,7 +4860,7 @@ bool Executor::rebaseObjects(ExecutionState &state, std::vector<ObjectPair> ops)
     if (!segmentOS) {
       uint32_t reserved = ExtendSegments ? ReserveSize : 0;
       segmentMO = memory->allocate(total_size + reserved, false, false, nullptr, 8,
-                                   &state.local_next_slot);
+                                   &state.localSpace);
       segmentOS = bindObjectInState(state, segmentMO, false);
       segmentOS->initializeToZero();
       klee_message("%p: creating new segment: %lu (size = %u)",
@@ -4397,7 +4876,9 @@ bool Executor::rebaseObjects(ExecutionState &state, std::vector<ObjectPair> ops)
 
   klee_message("%p: rebasing %lu objects at %u (line %u)",
                &state, ops.size(), state.prevPC->info->id, state.prevPC->info->line);
-  fillSegment(state, segmentMO, segmentOS, opsToRebase, offsets, seen);
+  if (!adopted) {
+    fillSegment(state, segmentMO, segmentOS, opsToRebase, offsets, seen);
+  }
 
   for (ObjectPair &op : opsToRebase) {
     state.unbindObject(op.first);
@@ -4410,11 +4891,21 @@ bool Executor::rebaseObjects(ExecutionState &state, std::vector<ObjectPair> ops)
   /* TODO: add docs */
   state.addRebaseID(rid);
 
+  ++stats::rebases;
+  stats::rebasedBytes += total_size;
+
   if (!seen) {
     /* TODO: add docs */
     assert(segmentMO);
-    RebaseInfo info(rid, segmentMO, ObjectHolder(segmentOS));
-    RebaseCache::getRebaseCache()->rebased.push_back(info);
+    /* with --reuse-segments, an immutable snapshot adopted by later states
+       (see adoptSegment) */
+    ObjectState *os = ReuseSegments ? new ObjectState(*segmentOS) : segmentOS;
+    RebaseInfo info(rid, segmentMO, ObjectHolder(os));
+    info.offsets = offsets;
+    RebaseCache::getRebaseCache()->add(info);
+    if (WriteResolveProfile) {
+      recordedProfile.addRebase(rid);
+    }
   }
 
   return true;
@@ -4466,45 +4957,99 @@ void Executor::fillSegment(ExecutionState &state,
 
     /* TODO: remove getEffectiveSize */
     uint64_t to_copy = os->getSubObjects().size() == 1 ? mo->size : os->getEffectiveSize();
-    for (unsigned j = 0; j < to_copy; j++) {
-      if (offset + j >= segmentOS->size) {
-        assert(0);
-      }
-      ref<Expr> old = segmentOS->read8(offset + j);
-      ref<Expr> n = os->read8(j);
-      if (!seen || (old->compare(*n.get()) != 0)) {
-        segmentOS->write(offset + j, n);
-      }
-    }
+    assert(offset + to_copy <= segmentOS->size);
+    /* if the segment was seen, write only the modified bytes */
+    segmentOS->copyFrom(offset, *os, 0, to_copy, seen);
 
     /* can't rebase fixed objects */
     assert(!os->getSubObjects().empty());
 
-    /* update constraints */
+    updateRebasedConstraints(state, mo, os, segmentMO->address + offset);
     for (auto subObject: os->getSubObjects()) {
-      klee_message("rebasing memory object: %lu -> %lu",
-                   mo->address + subObject.offset,
-                   segmentMO->address + offset + subObject.offset);
-      state.updateAddressConstraint(subObject.info.arrayID,
-                                    segmentMO->address + offset + subObject.offset);
       segmentOS->addSubObject(offset + subObject.offset, subObject.size, subObject.info);
     }
     for (auto subObject: os->getSubSegments()) {
-      klee_message("rebasing segment: %lu -> %lu",
-                   mo->address + subObject.offset,
-                   segmentMO->address + offset + subObject.offset);
-      state.updateAddressConstraint(subObject.info.arrayID,
-                                    segmentMO->address + offset + subObject.offset);
       segmentOS->addSubSegment(offset + subObject.offset, subObject.size, subObject.info);
     }
   }
 }
 
+void Executor::updateRebasedConstraints(ExecutionState &state,
+                                        const MemoryObject *mo,
+                                        const ObjectState *os,
+                                        uint64_t address) {
+  for (auto subObject: os->getSubObjects()) {
+    klee_message("rebasing memory object: %lu -> %lu",
+                 mo->address + subObject.offset,
+                 address + subObject.offset);
+    state.updateAddressConstraint(subObject.info.arrayID,
+                                  address + subObject.offset);
+  }
+  for (auto subObject: os->getSubSegments()) {
+    klee_message("rebasing segment: %lu -> %lu",
+                 mo->address + subObject.offset,
+                 address + subObject.offset);
+    state.updateAddressConstraint(subObject.info.arrayID,
+                                  address + subObject.offset);
+  }
+}
+
+bool Executor::adoptSegment(ExecutionState &state,
+                            RebaseInfo &ri,
+                            std::vector<ObjectPair> &ops,
+                            std::vector<unsigned int> &offsets) {
+  const MemoryObject *segmentMO = ri.mo;
+  const ObjectState *base = ri.oh;
+  const SymbolicAddressInfo &info = segmentMO->sainfo;
+
+  /* the objects are laid out differently than in the base */
+  if (offsets != ri.offsets) {
+    return false;
+  }
+
+  /* the segment is used by the state, or its address array is taken */
+  if (state.addressSpace.findObject(segmentMO) ||
+      state.hasAddressConstraint(info.arrayID)) {
+    return false;
+  }
+  ref<ConstantExpr> address = ConstantExpr::create(segmentMO->address, Expr::Int64);
+  ObjectPair op;
+  if (state.addressSpace.resolveOne(address, op)) {
+    return false;
+  }
+
+  state.addressSpace.bindSharedObject(segmentMO, base);
+  state.addAddressConstraint(info.arrayID, segmentMO->address, info.address);
+
+  /* copy only if the objects differ from the ones the base was built from */
+  assert(ops.size() == offsets.size());
+  for (unsigned i = 0; i < ops.size(); i++) {
+    const MemoryObject *mo = ops[i].first;
+    const ObjectState *os = ops[i].second;
+    unsigned offset = offsets[i];
+
+    /* the object moves into the segment, as in fillSegment */
+    addRebasedAddress(mo->address);
+
+    uint64_t to_copy = os->getSubObjects().size() == 1 ? mo->size : os->getEffectiveSize();
+    const ObjectState *segmentOS = state.addressSpace.findObject(segmentMO);
+    if (!segmentOS->isRangeEqual(offset, *os, 0, to_copy)) {
+      ObjectState *wos = state.addressSpace.getWriteable(segmentMO, segmentOS);
+      wos->copyFrom(offset, *os, 0, to_copy, true);
+    }
+
+    /* the base already has the layout */
+    updateRebasedConstraints(state, mo, os, segmentMO->address + offset);
+  }
+
+  return true;
+}
+
 void Executor::getContexts(ExecutionState &state,
                            std::vector<AllocationContext> &acs) {
   for (RebaseInfo &ri : RebaseCache::getRebaseCache()->rebased) {
-    if (ri.rid.info->id == state.prevPC->info->id) {
-      for (AllocationContext &ac : ri.rid.acs) {
+    if (ri.rid.getInfo()->id == state.prevPC->info->id) {
+      for (const AllocationContext &ac : ri.rid.getContexts()) {
         if (std::find(acs.begin(), acs.end(), ac) == acs.end()) {
           acs.push_back(ac);
         }
@@ -4516,22 +5061,16 @@ void Executor::getContexts(ExecutionState &state,
 void Executor::getArrays(ExecutionState &state,
                          std::set<uint64_t> &ids) {
   for (RebaseInfo &ri : RebaseCache::getRebaseCache()->rebased) {
-    if (ri.rid.info->id == state.prevPC->info->id) {
-      for (uint64_t &arrayID : ri.rid.arrays) {
+    if (ri.rid.getInfo()->id == state.prevPC->info->id) {
+      for (uint64_t arrayID : ri.rid.getArrays()) {
         ids.insert(arrayID);
       }
     }
   }
 }
 
-bool Executor::wasRebased(ExecutionState &state, const RebaseID &rid, RebaseInfo &result) {
-  for (RebaseInfo &ri : RebaseCache::getRebaseCache()->rebased) {
-    if (ri.rid == rid) {
-      result = ri;
-      return true;
-    }
-  }
-  return false;
+RebaseInfo *Executor::wasRebased(ExecutionState &state, const RebaseID &rid) {
+  return RebaseCache::getRebaseCache()->lookup(rid);
 }
 
 RebaseID Executor::buildRebaseID(ExecutionState &state,
@@ -4553,7 +5092,7 @@ RebaseID Executor::buildRebaseID(ExecutionState &state,
     addrs.push_back(mo->address);
   }
 
-  return RebaseID(state.prevPC->info, size, arrays, addrs, acs);
+  return RebaseID::create(state.prevPC->info, size, arrays, addrs, acs);
 }
 
 void Executor::traverseMO(ExecutionState &state,
@@ -4584,17 +5123,29 @@ void Executor::traverseMO(ExecutionState &state,
     }
 
     const ObjectState *os = op.second;
-    for (unsigned int i = 0; i + 8 <= os->size; i += 8) {
-      ref<Expr> e = os->read(i, Expr::Int64);
-      e = optimizer.optimizeExpr(e, true);
 
-      std::vector<AllocationContext> contexts;
-      ResolutionList rl;
-      solver->setTimeout(coreSolverTimeout);
-      state.addressSpace.resolve(state, solver, e, rl, contexts, 0, coreSolverTimeout);
-      solver->setTimeout(time::Span());
+    /* symbolic pointers, using the points-to records of the object */
+    std::set<uint64_t> ids;
+    os->getPointedArrays(ids);
+    for (uint64_t id : ids) {
+      if (!state.hasAddressConstraint(id)) {
+        continue;
+      }
+      ObjectPair rop;
+      if (state.addressSpace.resolveOne(state.getAddressConstraint(id)->address, rop)) {
+        worklist.push_back(std::make_pair(d + 1, rop));
+      }
+    }
 
-      for (ObjectPair &rop : rl) {
+    /* concrete pointers */
+    for (unsigned int i = 0; i + 8 <= os->size; i += 8) {
+      ref<Expr> e = os->read(i, Expr::Int64);
+      ConstantExpr *ce = dyn_cast<ConstantExpr>(e);
+      if (!ce) {
+        continue;
+      }
+      ObjectPair rop;
+      if (state.addressSpace.resolveOne(ce, rop)) {
         worklist.push_back(std::make_pair(d + 1, rop));
       }
     }
@@ -4612,32 +5163,95 @@ void Executor::traverseAll(ExecutionState &state,
   }
 }
 
+static void addFixedPartition(uint64_t size, std::vector<uint64_t> &partition) {
+  uint64_t total = 0;
+  while (total < size) {
+    partition.push_back(std::min((uint64_t)(PartitionSize), size - total));
+    total += PartitionSize;
+  }
+}
+
 void Executor::getPartition(const MemoryObject *mo,
                             const ObjectState *os,
-                            std::vector<uint64_t> &partition) {
-  if (PartitionSize % (Context::get().getPointerWidth() / 8) != 0) {
+                            std::vector<uint64_t> &partition,
+                            const AccessWindow *pending) {
+  uint64_t alignment = Context::get().getPointerWidth() / 8;
+  if (PartitionSize % alignment != 0) {
     klee_error("partition size must be aligned to pointer size");
   }
 
-  uint64_t total = 0;
-  while (total < mo->size) {
-    partition.push_back(std::min((uint64_t)(PartitionSize), mo->size - total));
-    total += PartitionSize;
+  std::vector<AccessWindow> windows;
+  if (PartitionByAccess) {
+    os->getAccessWindows(windows);
+    if (pending && (pending->offset != 0 || pending->size != mo->size)) {
+      auto i = std::find_if(windows.begin(), windows.end(),
+                            [pending](const AccessWindow &w) {
+                              return w.offset == pending->offset &&
+                                     w.size == pending->size;
+                            });
+      if (i != windows.end()) {
+        i->count += pending->count;
+      } else {
+        windows.push_back(*pending);
+      }
+    }
+  }
+
+  /* the frequently accessed windows, aligned to pointer size and merged
+     when they overlap, so such an access never spans two parts */
+  std::vector<std::pair<uint64_t, uint64_t>> hot;
+  for (const AccessWindow &w : windows) {
+    if (w.count < PartitionMinAccesses) {
+      continue;
+    }
+    uint64_t begin = w.offset / alignment * alignment;
+    uint64_t end = (w.offset + w.size + alignment - 1) / alignment * alignment;
+    hot.push_back(std::make_pair(begin, std::min<uint64_t>(end, mo->size)));
+  }
+  std::sort(hot.begin(), hot.end());
+
+  uint64_t offset = 0;
+  for (size_t i = 0; i < hot.size(); ) {
+    uint64_t begin = hot[i].first;
+    uint64_t end = hot[i].second;
+    for (i++; i < hot.size() && hot[i].first < end; i++) {
+      end = std::max(end, hot[i].second);
+    }
+    addFixedPartition(begin - offset, partition);
+    partition.push_back(end - begin);
+    offset = end;
   }
+  addFixedPartition(mo->size - offset, partition);
 }
 
 bool Executor::shouldSplit(ExecutionState &state,
                            const MemoryObject *mo,
                            const ObjectState *os,
-                           ref<Expr> offset) {
+                           ref<Expr> offset,
+                           Expr::Width type) {
   if (SplitObjects && !isa<ConstantExpr>(offset) && mo->size > SplitThreshold && PartitionSize < mo->size) {
     klee_warning("symbolic read from array of size %u", mo->size);
     if (os->getSubObjects().empty()) {
       klee_warning("can't split fixed object");
       return false;
-    } else {
-      return true;
     }
+
+    /* the current access is part of the decision, and is recorded only
+       if the object is split, since the read is then not performed */
+    unsigned base = 0, size = mo->size;
+    if (PartitionByAccess) {
+      os->getAccessWindow(offset, Expr::getMinBytesForWidth(type), base, size);
+    }
+    AccessWindow current(base, size, 1);
+
+    /* the accesses span the whole object */
+    std::vector<uint64_t> partition;
+    getPartition(mo, os, partition, &current);
+    if (partition.size() <= 1) {
+      return false;
+    }
+    os->recordAccess(base, size);
+    return true;
   } else {
     return false;
   }
@@ -4649,6 +5263,8 @@ bool Executor::splitMO(ExecutionState &state, ObjectPair op) {
     return false;
   }
 
+  TimerStatIncrementer timer(stats::splitTime);
+
   const MemoryObject *mo = op.first;
   const ObjectState *os = op.second;
 
@@ -4662,7 +5278,7 @@ bool Executor::splitMO(ExecutionState &state, ObjectPair op) {
 
   std::vector<const MemoryObject *> objects;
   memory->allocateWithPartition(partition, false, false, nullptr, 16,
-                                &state.local_next_slot, objects);
+                                &state.localSpace, objects);
   klee_message("splitting object %lu (size = %u) to %lu objects", mo->address, mo->size, objects.size());
 
   uint64_t offset = 0;
@@ -4671,10 +5287,13 @@ bool Executor::splitMO(ExecutionState &state, ObjectPair op) {
     ObjectState *newOS = bindObjectInState(state, newMO, false);
     newOS->isSplit = true;
     newOS->originalSize = os->size;
-    for (unsigned int i = 0; i < newMO->size; i++) {
-      ref<Expr> e = os->read8(offset + i);
-      newOS->write(i, e);
+    newOS->splitOffset = offset;
+    newOS->merged = os->merged;
+    if (offset == 0) {
+      newOS->splitSubObjects = os->getSubObjects();
+      newOS->splitSubSegments = os->getSubSegments();
     }
+    newOS->copyFrom(0, *os, offset, newMO->size);
     klee_message("binding new object: %lu (size = %u)", newMO->address, newMO->size);
     offset += newMO->size;
   }
@@ -4687,6 +5306,8 @@ bool Executor::splitMO(ExecutionState &state, ObjectPair op) {
   }
 
   state.unbindObject(mo);
+  state.splitObjects += objects.size();
+  ++stats::splits;
 
   /* TODO: add docs */
   state.updateRewrittenObjects();
@@ -4694,6 +5315,169 @@ bool Executor::splitMO(ExecutionState &state, ObjectPair op) {
   return true;
 }
 
+/* the address ranges of the symbolic pointers held in the registers of all
+   frames, including stale ones, as far as the range analysis can tell */
+static void getLivePointerRanges(const ExecutionState &state,
+                                 std::vector<ValueRange> &ranges) {
+  Expr::Width width = Context::get().getPointerWidth();
+  for (const StackFrame &sf : state.stack) {
+    for (unsigned i = 0; i < sf.kf->numRegisters; i++) {
+      ref<Expr> value = sf.locals[i].value;
+      if (value.isNull() || isa<klee::ConstantExpr>(value) ||
+          value->getWidth() != width) {
+        continue;
+      }
+      ref<Expr> address = state.unfold(value);
+      if (isa<klee::ConstantExpr>(address)) {
+        continue;
+      }
+      ValueRange range = OffsetRangeEvaluator().evaluate(address);
+      if (!range.isEmpty()) {
+        ranges.push_back(range);
+      }
+    }
+  }
+}
+
+/* Split parts are merged back only when no live symbolic pointer may point
+   into them, i.e. when the next symbolic access would not split the object
+   again right away. Merging does not change what is in memory, so pointers
+   that are stored in memory and loaded later are not considered. An
+   object is merged at most once: if it is split again, its parts stay
+   split, so it cannot flip between the two forms. */
+void Executor::mergeSplitObjects(ExecutionState &state) {
+  /* the parts are adjacent, so they are visited in order */
+  std::vector<std::vector<ObjectPair>> groups;
+  std::vector<ObjectPair> group;
+  unsigned size = 0;
+  unsigned count = 0;
+  for (MemoryMap::iterator i = state.addressSpace.objects.begin(),
+       e = state.addressSpace.objects.end(); i != e; ++i) {
+    const MemoryObject *mo = i->first;
+    const ObjectState *os = i->second;
+    if (!os->isSplit) {
+      group.clear();
+      continue;
+    }
+
+    count++;
+    if (os->splitOffset == 0) {
+      group.clear();
+      size = 0;
+    }
+    if (group.empty() ? os->splitOffset != 0 :
+        (os->splitOffset != size ||
+         os->originalSize != group[0].second->originalSize ||
+         mo->address != group[0].first->address + size)) {
+      group.clear();
+      continue;
+    }
+
+    group.push_back(ObjectPair(mo, os));
+    size += mo->size;
+    if (size == os->originalSize) {
+      groups.push_back(group);
+      group.clear();
+    }
+  }
+  state.splitObjects = count;
+  if (groups.empty()) {
+    return;
+  }
+
+  std::vector<ValueRange> live;
+  getLivePointerRanges(state, live);
+
+  bool updated = false;
+  for (std::vector<ObjectPair> &parts : groups) {
+    if (parts[0].second->merged) {
+      continue;
+    }
+
+    uint64_t begin = parts[0].first->address;
+    ValueRange covered(begin, begin + parts[0].second->originalSize - 1);
+    bool merge = true;
+    for (const ValueRange &range : live) {
+      if (range.intersects(covered)) {
+        merge = false;
+        break;
+      }
+    }
+    for (ObjectPair &op : parts) {
+      if (op.second->readOnly) {
+        merge = false;
+        break;
+      }
+    }
+    if (!merge) {
+      continue;
+    }
+
+    /* the merged object has the address of the first part, and the address
+       space is keyed by address, so the parts are unbound first (their
+       states are kept alive for the copy) */
+    std::vector<const MemoryObject *> objects;
+    std::vector<ObjectHolder> holders;
+    for (ObjectPair &op : parts) {
+      objects.push_back(op.first);
+      holders.push_back(ObjectHolder(const_cast<ObjectState *>(op.second)));
+      state.unbindObject(op.first);
+    }
+    state.splitObjects -= parts.size();
+
+    const MemoryObject *mo = memory->allocateMerged(objects);
+    ObjectState *os = bindObjectInState(state, mo, false);
+    os->merged = true;
+    for (ObjectPair &op : parts) {
+      os->copyFrom(op.second->splitOffset, *op.second, 0, op.first->size);
+    }
+    klee_message("merging %lu split objects to %lu (size = %u)",
+                 parts.size(), mo->address, mo->size);
+
+    /* restore the symbolic address of the original object */
+    const ObjectState *first = parts[0].second;
+    for (const SubObject &subObject : first->splitSubObjects) {
+      os->addSubObject(subObject.offset, subObject.size, subObject.info);
+    }
+    for (const SubObject &subObject : first->splitSubSegments) {
+      os->addSubSegment(subObject.offset, subObject.size, subObject.info);
+    }
+    if (!first->splitSubSegments.empty()) {
+      mo->sainfo = first->splitSubSegments[0].info;
+    } else if (!first->splitSubObjects.empty()) {
+      mo->sainfo = first->splitSubObjects[0].info;
+    }
+
+    /* update constraints */
+    for (const SubObject &subObject : os->getSubObjects()) {
+      uint64_t address = mo->address + subObject.offset;
+      ref<AddressRecord> ar = state.getAddressConstraint(subObject.info.arrayID);
+      if (ar->address->getZExtValue() != address) {
+        klee_message("rebasing memory object: %lu -> %lu",
+                     ar->address->getZExtValue(), address);
+        state.updateAddressConstraint(subObject.info.arrayID, address);
+        updated = true;
+      }
+    }
+    for (const SubObject &subObject : os->getSubSegments()) {
+      uint64_t address = mo->address + subObject.offset;
+      ref<AddressRecord> ar = state.getAddressConstraint(subObject.info.arrayID);
+      if (ar->address->getZExtValue() != address) {
+        klee_message("rebasing segment: %lu -> %lu",
+                     ar->address->getZExtValue(), address);
+        state.updateAddressConstraint(subObject.info.arrayID, address);
+        updated = true;
+      }
+    }
+  }
+
+  if (updated) {
+    /* TODO: add docs */
+    state.updateRewrittenObjects();
+    state.computeRewrittenConstraints();
+  }
+}
+
 void Executor::updateResolveCache(ExecutionState &state,
                                   std::vector<ObjectPair> &rl) {
   unsigned int id = state.prevPC->info->id;
@@ -4708,6 +5492,9 @@ void Executor::updateResolveCache(ExecutionState &state,
       contexts.push_back(op.first->ac);
       klee_message("updating resolve cache for instruction %u (hash = %lu)", id, op.first->ac.hash);
     }
+    if (WriteResolveProfile) {
+      recordedProfile.addResolved(id, op.first->ac);
+    }
   }
 }
 
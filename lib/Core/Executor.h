@@ -21,12 +21,15 @@
 #include "klee/Internal/Module/KInstruction.h"
 #include "klee/Internal/Module/KModule.h"
 #include "klee/Internal/System/Time.h"
+#include "klee/Solver.h"
 #include "klee/util/ArrayCache.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "llvm/ADT/Twine.h"
 
 #include "../Expr/ArrayExprOptimizer.h"
+#include "AddressArrayPool.h"
+#include "ResolveProfile.h"
 #include <map>
 #include <memory>
 #include <set>
@@ -51,6 +54,7 @@ namespace llvm {
 }
 
 namespace klee {  
+  struct AccessWindow;
   class Array;
   struct Cell;
   class ExecutionState;
@@ -60,6 +64,7 @@ namespace klee {
   struct KFunction;
   struct KInstruction;
   class KInstIterator;
+  struct KOperand;
   class KModule;
   class MemoryManager;
   class MemoryObject;
@@ -90,6 +95,10 @@ class Executor : public Interpreter {
   friend class StatsTracker;
   friend class MergeHandler;
   friend class MergingSearcher;
+  /* benchmarks/RelocationBenchmark.cpp drives the relocation primitives */
+  friend class RelocationFixture;
+  /* benchmarks/SymbolicAddressBenchmark.cpp drives symbolizeAddress */
+  friend class SymbolicAddressFixture;
 
 public:
   class Timer {
@@ -175,6 +184,10 @@ private:
   /// happens with other states (that don't satisfy the seeds) depends
   /// on as-yet-to-be-determined flags.
   std::map<ExecutionState*, std::vector<SeedInfo> > seedMap;
+
+  /// Branch directions (branch instruction, direction) that --concolic-seeds
+  /// already tried to explore against the seeds.
+  std::set<std::pair<KInstruction *, bool> > concolicNegated;
   
   /// Map of globals to their representative memory object.
   std::map<const llvm::GlobalValue*, MemoryObject*> globalObjects;
@@ -239,17 +252,43 @@ private:
   /// Optimizes expressions
   ExprOptimizer optimizer;
 
-  std::map<uint64_t, ref<Expr>> addressExpresssions;
+  /// The symbolic address arrays and their values
+  AddressArrayPool addressArrays;
 
   std::map<uint64_t, std::vector<AllocationContext>> resolveCache;
 
   std::set<uint64_t> rebasedAddresses;
 
+  /// Resolution sets and rebase outcomes of a previous run, loaded with
+  /// --resolve-profile. Only these groups place allocations in profiled
+  /// segments.
+  ResolveProfile loadedProfile;
+
+  /// Resolution sets and rebase outcomes of this run, recorded only with
+  /// --write-resolve-profile
+  ResolveProfile recordedProfile;
+
   llvm::Function* getTargetFunction(llvm::Value *calledVal,
                                     ExecutionState &state);
   
   void executeInstruction(ExecutionState &state, KInstruction *ki);
 
+  typedef void (Executor::*InstructionHandler)(ExecutionState &state,
+                                               KInstruction *ki);
+
+  /// Handlers indexed by KOpcode, Generic is executeInstruction.
+  static const InstructionHandler instructionHandlers[];
+
+  void dispatchInstruction(ExecutionState &state, KInstruction *ki);
+
+  template <typename Op>
+  void executeBinary(ExecutionState &state, KInstruction *ki);
+  template <typename Op>
+  void executeCast(ExecutionState &state, KInstruction *ki);
+  void executeBitCast(ExecutionState &state, KInstruction *ki);
+  void executeBranch(ExecutionState &state, KInstruction *ki);
+  void executePHI(ExecutionState &state, KInstruction *ki);
+
   void printFileLine(ExecutionState &state, KInstruction *ki,
                      llvm::raw_ostream &file);
 
@@ -361,6 +400,14 @@ private:
   // current state, and one of the states may be null.
   StatePair fork(ExecutionState &current, ref<Expr> condition, bool isInternal);
 
+  /// Decide a branch of a seeded state by evaluating the condition on its
+  /// seeds (--concolic-seeds). The solver is only asked whether the side no
+  /// seed takes is feasible, once per branch direction, and answers the
+  /// query as usual when the seeds do not bind every array of condition.
+  /// Returns false on solver failure.
+  bool concolicEvaluate(ExecutionState &state, ref<Expr> condition,
+                        std::vector<SeedInfo> &seeds, Solver::Validity &res);
+
   /// Add the given (boolean) condition as a constraint on state. This
   /// function is a wrapper around the state's addConstraint function
   /// which also manages propagation of implied values,
@@ -374,15 +421,27 @@ private:
   const Cell& eval(KInstruction *ki, unsigned index, 
                    ExecutionState &state) const;
 
+  /// Like eval, but only succeeds for concrete operands of at most 64
+  /// bits and never creates an expression.
+  bool evalConcrete(KInstruction *ki, unsigned index, ExecutionState &state,
+                    uint64_t &value, Expr::Width &width) const;
+
+  /// evalConcrete for an operand resolved when decoding, see KOperand.
+  bool evalConcrete(const KOperand &slot, ExecutionState &state,
+                    uint64_t &value, Expr::Width &width) const;
+
+  /// The value of an operand resolved when decoding, see KOperand.
+  ref<Expr> evalOperand(const KOperand &slot, ExecutionState &state) const;
+
   Cell& getArgumentCell(ExecutionState &state,
                         KFunction *kf,
                         unsigned index) {
-    return state.stack.back().locals[kf->getArgRegister(index)];
+    return state.stack.back().locals.getMutable(kf->getArgRegister(index));
   }
 
   Cell& getDestCell(ExecutionState &state,
                     KInstruction *target) {
-    return state.stack.back().locals[target->dest];
+    return state.stack.back().locals.getMutable(target->dest);
   }
 
   void bindLocal(KInstruction *target, 
@@ -393,6 +452,10 @@ private:
                     ExecutionState &state,
                     ref<Expr> value);
 
+  /// Bind a concrete value inline, without creating an expression.
+  void bindLocalConcrete(KInstruction *target, ExecutionState &state,
+                         uint64_t value, Expr::Width width);
+
   /// Evaluates an LLVM constant expression.  The optional argument ki
   /// is the instruction where this constant was encountered, or NULL
   /// if not applicable/unavailable.
@@ -562,6 +625,18 @@ public:
                    const MemoryObject *mo,
                    SymbolicAddressInfo &info);
 
+  void symbolizeAddress(ExecutionState &state,
+                        uint64_t address,
+                        SymbolicAddressInfo &info);
+
+  bool allocateInProfiledSegment(ExecutionState &state,
+                                 uint64_t group,
+                                 uint64_t size,
+                                 bool zeroMemory,
+                                 KInstruction *target);
+
+  void writeResolveProfile();
+
   void rebaseObject(ExecutionState &state, ObjectPair &op);
 
   bool rebaseObjects(ExecutionState &state, std::vector<ObjectPair> ops);
@@ -577,11 +652,25 @@ public:
                    std::vector<unsigned int> &offsets,
                    bool seen);
 
+  void updateRebasedConstraints(ExecutionState &state,
+                                const MemoryObject *mo,
+                                const ObjectState *os,
+                                uint64_t address);
+
+  /* binds the snapshot of a previous rebase with the same id (copy on
+     write), returns false if the state can't use it, e.g. because its
+     objects are at other offsets */
+  bool adoptSegment(ExecutionState &state,
+                    RebaseInfo &ri,
+                    std::vector<ObjectPair> &ops,
+                    std::vector<unsigned int> &offsets);
+
   void getContexts(ExecutionState &state, std::vector<AllocationContext> &acs);
 
   void getArrays(ExecutionState &state, std::set<uint64_t> &ids);
 
-  bool wasRebased(ExecutionState &state, const RebaseID &rid, RebaseInfo &result);
+  /* returns null if the rebase was not seen yet */
+  RebaseInfo *wasRebased(ExecutionState &state, const RebaseID &rid);
 
   RebaseID buildRebaseID(ExecutionState &state,
                          std::vector<ObjectPair> &ops,
@@ -597,17 +686,25 @@ public:
                    unsigned int depth,
                    ResolutionList &result);
 
+  /* the part sizes of a split, keeping the windows accessed at least
+     --partition-min-accesses times (including a pending access) whole */
   void getPartition(const MemoryObject *mo,
                     const ObjectState *os,
-                    std::vector<uint64_t> &partition);
+                    std::vector<uint64_t> &partition,
+                    const AccessWindow *pending = nullptr);
 
   bool shouldSplit(ExecutionState &state,
                    const MemoryObject *mo,
                    const ObjectState *os,
-                   ref<Expr> offset);
+                   ref<Expr> offset,
+                   Expr::Width type);
 
   bool splitMO(ExecutionState &state, ObjectPair op);
 
+  /* merges back the parts of split objects that are no longer accessed
+     with symbolic offsets */
+  void mergeSplitObjects(ExecutionState &state);
+
   void updateResolveCache(ExecutionState &state, std::vector<ObjectPair> &rl);
 
   void getResolvedContexts(ExecutionState &state, std::vector<AllocationContext> &contexts);
@@ -27,6 +27,7 @@
 #include "llvm/Support/raw_ostream.h"
 
 #include <cassert>
+#include <cstring>
 #include <sstream>
 
 using namespace llvm;
@@ -38,6 +39,24 @@ namespace {
                     cl::desc("Use constant arrays instead of updates when possible (default=true)\n"),
                     cl::init(true),
                     cl::cat(SolvingCat));
+
+  cl::opt<bool>
+  UseOffsetRangeAnalysis("use-offset-range-analysis",
+                         cl::desc("Flush only the bytes a symbolic offset may "
+                                  "point to, using a range analysis of the "
+                                  "offset (default=false)"),
+                         cl::init(false),
+                         cl::cat(SolvingCat));
+
+  cl::opt<bool>
+  UseWordUpdates("use-word-updates",
+                 cl::desc("Write a multi-byte value at a symbolic offset as "
+                          "a single update (default=true)"),
+                 cl::init(true),
+                 cl::cat(SolvingCat));
+
+  /* bounds the per-object access histogram */
+  const unsigned MaxAccessWindows = 64;
 }
 
 /***/
@@ -99,8 +118,8 @@ ObjectState::ObjectState(const MemoryObject *mo)
     refCount(0),
     object(mo),
     concreteStore(new uint8_t[mo->size]),
+    version(++lastVersion),
     concreteMask(0),
-    flushMask(0),
     knownSymbolics(0),
     updates(0, 0),
     rewrittenUpdates(0, 0),
@@ -109,7 +128,9 @@ ObjectState::ObjectState(const MemoryObject *mo)
     size(mo->size),
     readOnly(false),
     originalSize(0),
-    isSplit(false) {
+    isSplit(false),
+    splitOffset(0),
+    merged(false) {
   mo->refCount++;
   if (!UseConstantArrays) {
     static unsigned id = 0;
@@ -126,8 +147,8 @@ ObjectState::ObjectState(const MemoryObject *mo, const Array *array)
     refCount(0),
     object(mo),
     concreteStore(new uint8_t[mo->size]),
+    version(++lastVersion),
     concreteMask(0),
-    flushMask(0),
     knownSymbolics(0),
     updates(array, 0),
     rewrittenUpdates(0, 0),
@@ -136,7 +157,9 @@ ObjectState::ObjectState(const MemoryObject *mo, const Array *array)
     size(mo->size),
     readOnly(false),
     originalSize(0),
-    isSplit(false) {
+    isSplit(false),
+    splitOffset(0),
+    merged(false) {
   mo->refCount++;
   makeSymbolic();
   memset(concreteStore, 0, size);
@@ -149,17 +172,25 @@ ObjectState::ObjectState(const ObjectState &os)
     subObjects(os.subObjects),
     subSegments(os.subSegments),
     concreteStore(new uint8_t[os.size]),
+    version(os.version),
     concreteMask(os.concreteMask ? new BitArray(*os.concreteMask, os.size) : 0),
-    flushMask(os.flushMask ? new BitArray(*os.flushMask, os.size) : 0),
+    flushed(os.flushed),
     knownSymbolics(0),
     updates(os.updates),
     rewrittenUpdates(os.rewrittenUpdates),
     pulledUpdates(os.pulledUpdates),
     minUpdates(os.minUpdates),
+    pointers(os.pointers),
+    unplacedPointers(os.unplacedPointers),
+    accessWindows(os.accessWindows),
     size(os.size),
     readOnly(false),
     originalSize(os.originalSize),
-    isSplit(os.isSplit) {
+    isSplit(os.isSplit),
+    splitOffset(os.splitOffset),
+    splitSubObjects(os.splitSubObjects),
+    splitSubSegments(os.splitSubSegments),
+    merged(os.merged) {
   assert(!os.readOnly && "no need to copy read only object?");
   if (object)
     object->refCount++;
@@ -175,7 +206,6 @@ ObjectState::ObjectState(const ObjectState &os)
 
 ObjectState::~ObjectState() {
   delete concreteMask;
-  delete flushMask;
   delete[] knownSymbolics;
   delete[] concreteStore;
 
@@ -228,7 +258,7 @@ const UpdateList &ObjectState::getUpdates() const {
         break;
 
       ConstantExpr *Value = dyn_cast<ConstantExpr>(Writes[Begin].second);
-      if (!Value)
+      if (!Value || Value->getWidth() != Expr::Int8)
         break;
 
       Contents[Index->getZExtValue()] = Value;
@@ -260,17 +290,19 @@ void ObjectState::flushToConcreteStore(TimingSolver *solver,
                      (void *)object->address, i);
       else
         ce->toMemory(concreteStore + i);
+      markChanged();
     }
   }
 }
 
 void ObjectState::makeConcrete() {
   delete concreteMask;
-  delete flushMask;
   delete[] knownSymbolics;
   concreteMask = 0;
-  flushMask = 0;
+  flushed.clear();
   knownSymbolics = 0;
+  pointers.clear();
+  unplacedPointers.clear();
 }
 
 void ObjectState::makeSymbolic() {
@@ -288,6 +320,7 @@ void ObjectState::makeSymbolic() {
 void ObjectState::initializeToZero() {
   makeConcrete();
   memset(concreteStore, 0, size);
+  markChanged();
 }
 
 void ObjectState::initializeToRandom() {  
@@ -296,6 +329,7 @@ void ObjectState::initializeToRandom() {
     // randomly selected by 256 sided die
     concreteStore[i] = 0xAB;
   }
+  markChanged();
 }
 
 /*
@@ -307,50 +341,60 @@ isByteConcrete(i) => !isByteKnownSymbolic(i)
  */
 
 void ObjectState::fastRangeCheckOffset(ref<Expr> offset,
+                                       unsigned bytes,
                                        unsigned *base_r,
                                        unsigned *size_r) const {
   *base_r = 0;
   *size_r = size;
+
+  // Only in bounds values matter, the access is guarded by a bounds check.
+  ValueRange range = OffsetRangeEvaluator().evaluate(offset);
+  if (range.isEmpty() || range.min() >= size)
+    return;
+
+  uint64_t last = std::min<uint64_t>(range.max(), size - 1);
+  last = std::min<uint64_t>(last + bytes - 1, size - 1);
+  *base_r = range.min();
+  *size_r = last - range.min() + 1;
 }
 
 void ObjectState::flushRangeForRead(unsigned rangeBase, 
                                     unsigned rangeSize) const {
-  if (!flushMask) flushMask = new BitArray(size, true);
- 
-  for (unsigned offset=rangeBase; offset<rangeBase+rangeSize; offset++) {
-    if (!isByteFlushed(offset)) {
-      if (isByteConcrete(offset)) {
-        updates.extend(ConstantExpr::create(offset, Expr::Int32),
-                       ConstantExpr::create(concreteStore[offset], Expr::Int8));
-      } else {
-        assert(isByteKnownSymbolic(offset) && "invalid bit set in flushMask");
-        updates.extend(ConstantExpr::create(offset, Expr::Int32),
-                       knownSymbolics[offset]);
-      }
+  unsigned rangeEnd = rangeBase + rangeSize;
+  for (unsigned offset=rangeBase; offset<rangeEnd; offset++) {
+    unsigned next = flushed.skip(offset);
+    if (next != offset) {
+      offset = next - 1;
+      continue;
+    }
 
-      flushMask->unset(offset);
+    if (isByteConcrete(offset)) {
+      updates.extend(ConstantExpr::create(offset, Expr::Int32),
+                     ConstantExpr::create(concreteStore[offset], Expr::Int8));
+    } else {
+      assert(isByteKnownSymbolic(offset) && "unflushed byte without cache value");
+      updates.extend(ConstantExpr::create(offset, Expr::Int32),
+                     knownSymbolics[offset]);
     }
-  } 
+  }
+  flushed.insert(rangeBase, rangeEnd);
 }
 
 void ObjectState::flushRangeForWrite(unsigned rangeBase, 
                                      unsigned rangeSize) {
-  if (!flushMask) flushMask = new BitArray(size, true);
-
-  for (unsigned offset=rangeBase; offset<rangeBase+rangeSize; offset++) {
+  unsigned rangeEnd = rangeBase + rangeSize;
+  for (unsigned offset=rangeBase; offset<rangeEnd; offset++) {
     if (!isByteFlushed(offset)) {
       if (isByteConcrete(offset)) {
         updates.extend(ConstantExpr::create(offset, Expr::Int32),
                        ConstantExpr::create(concreteStore[offset], Expr::Int8));
         markByteSymbolic(offset);
       } else {
-        assert(isByteKnownSymbolic(offset) && "invalid bit set in flushMask");
+        assert(isByteKnownSymbolic(offset) && "unflushed byte without cache value");
         updates.extend(ConstantExpr::create(offset, Expr::Int32),
                        knownSymbolics[offset]);
         setKnownSymbolic(offset, 0);
       }
-
-      flushMask->unset(offset);
     } else {
       // flushed bytes that are written over still need
       // to be marked out
@@ -361,6 +405,7 @@ void ObjectState::flushRangeForWrite(unsigned rangeBase,
       }
     }
   } 
+  flushed.insert(rangeBase, rangeEnd);
 }
 
 bool ObjectState::isByteConcrete(unsigned offset) const {
@@ -368,7 +413,7 @@ bool ObjectState::isByteConcrete(unsigned offset) const {
 }
 
 bool ObjectState::isByteFlushed(unsigned offset) const {
-  return flushMask && !flushMask->get(offset);
+  return flushed.contains(offset);
 }
 
 bool ObjectState::isByteKnownSymbolic(unsigned offset) const {
@@ -387,16 +432,12 @@ void ObjectState::markByteSymbolic(unsigned offset) {
 }
 
 void ObjectState::markByteUnflushed(unsigned offset) {
-  if (flushMask)
-    flushMask->set(offset);
+  if (!flushed.empty())
+    flushed.erase(offset, offset + 1);
 }
 
 void ObjectState::markByteFlushed(unsigned offset) {
-  if (!flushMask) {
-    flushMask = new BitArray(size, false);
-  } else {
-    flushMask->unset(offset);
-  }
+  flushed.insert(offset, offset + 1);
 }
 
 void ObjectState::setKnownSymbolic(unsigned offset, 
@@ -426,10 +467,34 @@ ref<Expr> ObjectState::read8(unsigned offset) const {
   }    
 }
 
-ref<Expr> ObjectState::read8(ref<Expr> offset) const {
-  assert(!isa<ConstantExpr>(offset) && "constant offset passed to symbolic read8");
-  unsigned base, size;
-  fastRangeCheckOffset(offset, &base, &size);
+uint64_t ObjectState::lastVersion = 0;
+
+bool ObjectState::recordAccesses = false;
+
+void ObjectState::recordAccess(unsigned base, unsigned size) const {
+  /* an access that may touch the whole object tells nothing */
+  if (base == 0 && size == this->size)
+    return;
+
+  auto i = accessWindows.find(std::make_pair(base, size));
+  if (i != accessWindows.end()) {
+    i->second++;
+  } else if (accessWindows.size() < MaxAccessWindows) {
+    accessWindows[std::make_pair(base, size)] = 1;
+  }
+}
+
+void ObjectState::flushForRead(ref<Expr> offset, unsigned bytes) const {
+  unsigned base = 0, size = this->size;
+  if (UseOffsetRangeAnalysis || recordAccesses) {
+    fastRangeCheckOffset(offset, bytes, &base, &size);
+    if (recordAccesses)
+      recordAccess(base, size);
+    if (!UseOffsetRangeAnalysis) {
+      base = 0;
+      size = this->size;
+    }
+  }
   flushRangeForRead(base, size);
 
   if (size>4096) {
@@ -439,13 +504,40 @@ ref<Expr> ObjectState::read8(ref<Expr> offset) const {
                       size,
                       allocInfo.c_str());
   }
-  
+}
+
+void ObjectState::flushForWrite(ref<Expr> offset, unsigned bytes) {
+  unsigned base = 0, size = this->size;
+  if (UseOffsetRangeAnalysis || recordAccesses) {
+    fastRangeCheckOffset(offset, bytes, &base, &size);
+    if (recordAccesses)
+      recordAccess(base, size);
+    if (!UseOffsetRangeAnalysis) {
+      base = 0;
+      size = this->size;
+    }
+  }
+  flushRangeForWrite(base, size);
+
+  if (size>4096) {
+    std::string allocInfo;
+    object->getAllocInfo(allocInfo);
+    klee_warning_once(0, "flushing %d bytes on read, may be slow and/or crash: %s", 
+                      size,
+                      allocInfo.c_str());
+  }
+}
+
+ref<Expr> ObjectState::read8(ref<Expr> offset) const {
+  assert(!isa<ConstantExpr>(offset) && "constant offset passed to symbolic read8");
+  flushForRead(offset);
   return ReadExpr::create(getUpdates(), ZExtExpr::create(offset, Expr::Int32));
 }
 
 void ObjectState::write8(unsigned offset, uint8_t value) {
   //assert(read_only == false && "writing to read-only object!");
   concreteStore[offset] = value;
+  markChanged();
   setKnownSymbolic(offset, 0);
 
   markByteConcrete(offset);
@@ -466,18 +558,7 @@ void ObjectState::write8(unsigned offset, ref<Expr> value) {
 
 void ObjectState::write8(ref<Expr> offset, ref<Expr> value) {
   assert(!isa<ConstantExpr>(offset) && "constant offset passed to symbolic write8");
-  unsigned base, size;
-  fastRangeCheckOffset(offset, &base, &size);
-  flushRangeForWrite(base, size);
-
-  if (size>4096) {
-    std::string allocInfo;
-    object->getAllocInfo(allocInfo);
-    klee_warning_once(0, "flushing %d bytes on read, may be slow and/or crash: %s", 
-                      size,
-                      allocInfo.c_str());
-  }
-  
+  flushForWrite(offset);
   updates.extend(ZExtExpr::create(offset, Expr::Int32), value);
 }
 
@@ -495,15 +576,19 @@ ref<Expr> ObjectState::read(ref<Expr> offset, Expr::Width width) const {
   if (width == Expr::Bool)
     return ExtractExpr::create(read8(offset), 0, Expr::Bool);
 
-  // Otherwise, follow the slow general case.
+  // Otherwise, follow the slow general case. The whole access covers the same
+  // range, so flush it once and read all the bytes from the same updates.
   unsigned NumBytes = width / 8;
   assert(width == NumBytes * 8 && "Invalid read size!");
+  flushForRead(offset, NumBytes);
+  const UpdateList &ul = getUpdates();
   ref<Expr> Res(0);
   for (unsigned i = 0; i != NumBytes; ++i) {
     unsigned idx = Context::get().isLittleEndian() ? i : (NumBytes - i - 1);
-    ref<Expr> Byte = read8(AddExpr::create(offset, 
-                                           ConstantExpr::create(idx, 
-                                                                Expr::Int32)));
+    ref<Expr> Byte = ReadExpr::create(ul,
+                                      AddExpr::create(offset,
+                                                      ConstantExpr::create(idx,
+                                                                           Expr::Int32)));
     Res = i ? ConcatExpr::create(Byte, Res) : Byte;
   }
 
@@ -538,6 +623,12 @@ void ObjectState::write(ref<Expr> offset, ref<Expr> value) {
     return;
   }
 
+  if (value->flag) {
+    AddressArrayCollector collector;
+    collector.visit(value);
+    unplacedPointers.insert(collector.ids.begin(), collector.ids.end());
+  }
+
   // Treat bool specially, it is the only non-byte sized write we allow.
   Expr::Width w = value->getWidth();
   if (w == Expr::Bool) {
@@ -545,17 +636,29 @@ void ObjectState::write(ref<Expr> offset, ref<Expr> value) {
     return;
   }
 
-  // Otherwise, follow the slow general case.
+  // Otherwise, follow the slow general case. As with reads, the range is
+  // flushed once for the whole access.
   unsigned NumBytes = w / 8;
   assert(w == NumBytes * 8 && "Invalid write size!");
+  flushForWrite(offset, NumBytes);
+
+  // A little endian value already has the byte at offset in its low bits,
+  // which is the layout of an update of several bytes.
+  if (UseWordUpdates && Context::get().isLittleEndian()) {
+    updates.extend(offset, value);
+    return;
+  }
+
   for (unsigned i = 0; i != NumBytes; ++i) {
     unsigned idx = Context::get().isLittleEndian() ? i : (NumBytes - i - 1);
-    write8(AddExpr::create(offset, ConstantExpr::create(idx, Expr::Int32)),
-           ExtractExpr::create(value, 8 * i, Expr::Int8));
+    updates.extend(AddExpr::create(offset, ConstantExpr::create(idx, Expr::Int32)),
+                   ExtractExpr::create(value, 8 * i, Expr::Int8));
   }
 }
 
 void ObjectState::write(unsigned offset, ref<Expr> value) {
+  updatePointers(offset, value);
+
   // Check for writes of constant values.
   if (ConstantExpr *CE = dyn_cast<ConstantExpr>(value)) {
     Expr::Width w = CE->getWidth();
@@ -612,6 +715,87 @@ void ObjectState::write64(unsigned offset, uint64_t value) {
   }
 }
 
+void ObjectState::writeConcreteRange(unsigned offset, const uint8_t *values,
+                                     unsigned count) {
+  memmove(concreteStore + offset, values, count);
+  markChanged();
+  if (knownSymbolics) {
+    for (unsigned i = offset; i < offset + count; i++)
+      knownSymbolics[i] = ref<Expr>();
+  }
+
+  if (concreteMask)
+    concreteMask->setRange(offset, count, true);
+  flushed.erase(offset, offset + count);
+}
+
+bool ObjectState::isRangeConcrete(unsigned offset, unsigned count) const {
+  for (unsigned i = offset; i < offset + count; i++) {
+    if (!isByteConcrete(i))
+      return false;
+  }
+  return true;
+}
+
+void ObjectState::copyFrom(unsigned offset, const ObjectState &src,
+                           unsigned srcOffset, unsigned count,
+                           bool onlyChanged) {
+  assert(offset + count <= size && "copy out of bounds");
+  assert(srcOffset + count <= src.size && "copy out of bounds");
+
+  copyPointers(offset, src, srcOffset, count);
+
+  unsigned i = 0;
+  while (i < count) {
+    /* find the next span of concrete bytes */
+    unsigned j = i;
+    while (j < count && src.isByteConcrete(srcOffset + j))
+      j++;
+
+    if (j > i) {
+      const uint8_t *values = src.concreteStore + srcOffset + i;
+      if (!onlyChanged || !isRangeConcrete(offset + i, j - i) ||
+          memcmp(concreteStore + offset + i, values, j - i) != 0) {
+        writeConcreteRange(offset + i, values, j - i);
+      }
+      i = j;
+      continue;
+    }
+
+    ref<Expr> value = src.read8(srcOffset + i);
+    if (!onlyChanged || read8(offset + i)->compare(*value.get()) != 0)
+      write8(offset + i, value);
+    i++;
+  }
+}
+
+bool ObjectState::isRangeEqual(unsigned offset, const ObjectState &src,
+                               unsigned srcOffset, unsigned count) const {
+  assert(offset + count <= size && "compare out of bounds");
+  assert(srcOffset + count <= src.size && "compare out of bounds");
+
+  unsigned i = 0;
+  while (i < count) {
+    unsigned j = i;
+    while (j < count && src.isByteConcrete(srcOffset + j))
+      j++;
+
+    if (j > i) {
+      if (!isRangeConcrete(offset + i, j - i) ||
+          memcmp(concreteStore + offset + i,
+                 src.concreteStore + srcOffset + i, j - i) != 0)
+        return false;
+      i = j;
+      continue;
+    }
+
+    if (read8(offset + i)->compare(*src.read8(srcOffset + i).get()) != 0)
+      return false;
+    i++;
+  }
+  return true;
+}
+
 void ObjectState::print() const {
   llvm::errs() << "-- ObjectState --\n";
   llvm::errs() << "\tMemoryObject ID: " << object->id << "\n";
@@ -645,6 +829,69 @@ void ObjectState::getArrays(std::set<const Array *> &arrays) const {
   }
 }
 
+void ObjectState::updatePointers(unsigned offset, ref<Expr> value) {
+  unsigned bytes = std::max(value->getWidth() / 8, 1u);
+
+  /* drop the records that are overwritten entirely */
+  if (!pointers.empty()) {
+    auto i = pointers.lower_bound(offset);
+    while (i != pointers.end() && i->first < offset + bytes) {
+      if (i->first + i->second.size <= offset + bytes) {
+        i = pointers.erase(i);
+      } else {
+        i++;
+      }
+    }
+  }
+
+  if (value->flag) {
+    AddressArrayCollector collector;
+    collector.visit(value);
+    if (!collector.ids.empty()) {
+      pointers[offset] = PointerRecord(bytes, collector.ids);
+    }
+  }
+}
+
+void ObjectState::copyPointers(unsigned offset, const ObjectState &src,
+                               unsigned srcOffset, unsigned count) {
+  if (!pointers.empty()) {
+    auto i = pointers.lower_bound(offset);
+    while (i != pointers.end() && i->first < offset + count) {
+      if (i->first + i->second.size <= offset + count) {
+        i = pointers.erase(i);
+      } else {
+        i++;
+      }
+    }
+  }
+
+  for (auto i = src.pointers.lower_bound(srcOffset);
+       i != src.pointers.end() && i->first < srcOffset + count; i++) {
+    pointers[offset + (i->first - srcOffset)] = i->second;
+  }
+  unplacedPointers.insert(src.unplacedPointers.begin(),
+                          src.unplacedPointers.end());
+}
+
+void ObjectState::getPointedArrays(std::set<uint64_t> &ids) const {
+  for (auto &i : pointers) {
+    ids.insert(i.second.arrays.begin(), i.second.arrays.end());
+  }
+  ids.insert(unplacedPointers.begin(), unplacedPointers.end());
+}
+
+void ObjectState::getAccessWindow(ref<Expr> offset, unsigned bytes,
+                                  unsigned &base, unsigned &size) const {
+  fastRangeCheckOffset(offset, bytes, &base, &size);
+}
+
+void ObjectState::getAccessWindows(std::vector<AccessWindow> &windows) const {
+  for (auto &i : accessWindows) {
+    windows.push_back(AccessWindow(i.first.first, i.first.second, i.second));
+  }
+}
+
 bool ObjectState::isSegment() const {
   return !subSegments.empty();
 }
@@ -14,9 +14,14 @@
 #include "TimingSolver.h"
 #include "AllocationContext.h"
 #include "klee/Expr.h"
+#include "klee/Internal/ADT/IntervalSet.h"
+#include "klee/util/ExprRangeEvaluator.h"
+#include "klee/util/ValueRange.h"
 
 #include "llvm/ADT/StringExtras.h"
 
+#include <map>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -185,6 +190,56 @@ struct SubObject {
   }
 };
 
+/* the address arrays referred to by a value stored in an object */
+struct PointerRecord {
+  /* the number of bytes written */
+  unsigned size;
+  std::vector<uint64_t> arrays;
+
+  PointerRecord() : size(0) {
+
+  }
+
+  PointerRecord(unsigned size, const std::set<uint64_t> &ids) :
+    size(size), arrays(ids.begin(), ids.end())
+  {
+
+  }
+};
+
+/// Computes the possible values of an offset or address expression.
+class OffsetRangeEvaluator : public ExprRangeEvaluator<ValueRange> {
+public:
+  /// Deep enough for an array index read from memory; the evaluation is
+  /// not memoized, so it must stay cheap on large shared expressions.
+  static const unsigned MaxDepth = 12;
+
+  OffsetRangeEvaluator() : ExprRangeEvaluator<ValueRange>(MaxDepth) {}
+
+protected:
+  ValueRange getInitialReadRange(const Array &array, ValueRange index) {
+    if (array.isConstantArray() && index.isFixed() &&
+        index.min() < array.size)
+      return ValueRange(array.constantValues[index.min()]->getZExtValue(8));
+
+    return ValueRange(0, 255);
+  }
+};
+
+/* the offsets that symbolic accesses to an object may touch */
+struct AccessWindow {
+  unsigned offset;
+  unsigned size;
+  /* the number of accesses observed with this window */
+  unsigned count;
+
+  AccessWindow(unsigned offset, unsigned size, unsigned count) :
+    offset(offset), size(size), count(count)
+  {
+
+  }
+};
+
 class ObjectState {
 private:
   friend class AddressSpace;
@@ -203,11 +258,17 @@ private:
 
   uint8_t *concreteStore;
 
+  /* identifies the contents of concreteStore: copies share the version,
+     every change gets a fresh one */
+  mutable uint64_t version;
+  static uint64_t lastVersion;
+
   // XXX cleanup name of flushMask (its backwards or something)
   BitArray *concreteMask;
 
+  // the bytes whose value is in updates
   // mutable because may need flushed during read of const
-  mutable BitArray *flushMask;
+  mutable IntervalSet flushed;
 
   ref<Expr> *knownSymbolics;
 
@@ -220,13 +281,35 @@ private:
 
   mutable size_t minUpdates;
 
+  /* offset -> address arrays referred to by the value written there,
+     maintained on writes (an over-approximation, may have stale entries) */
+  std::map<unsigned, PointerRecord> pointers;
+  /* address arrays written at symbolic offsets */
+  std::set<uint64_t> unplacedPointers;
+
+  /* (offset, size) -> count, the feasible windows of symbolic accesses */
+  mutable std::map<std::pair<unsigned, unsigned>, unsigned> accessWindows;
+
 public:
+  /* whether the flushes record the access windows, set by the executor
+     when split objects are partitioned by access */
+  static bool recordAccesses;
+
   unsigned size;
 
   bool readOnly;
 
   unsigned originalSize;
   bool isSplit;
+  /* the offset of a split part in the original object */
+  unsigned splitOffset;
+  /* the sub-objects of the original object, kept by the first part */
+  std::vector<SubObject> splitSubObjects;
+  std::vector<SubObject> splitSubSegments;
+
+  /* this object, or the object it was split from, was merged back from
+     split parts, see Executor::mergeSplitObjects */
+  bool merged;
 
 public:
   /// Create a new object state for the given memory object with concrete
@@ -279,6 +362,9 @@ public:
   // make contents all concrete and random
   void initializeToRandom();
 
+  // Multi-byte accesses at a symbolic offset flush the range once, but are
+  // still represented byte by byte: one ReadExpr (or UpdateNode) per byte.
+  // Update lists have no multi-byte nodes.
   ref<Expr> read(ref<Expr> offset, Expr::Width width) const;
   ref<Expr> read(unsigned offset, Expr::Width width) const;
   ref<Expr> read8(unsigned offset) const;
@@ -291,6 +377,20 @@ public:
   void write16(unsigned offset, uint16_t value);
   void write32(unsigned offset, uint32_t value);
   void write64(unsigned offset, uint64_t value);
+
+  /// Copies count bytes of src (starting at srcOffset) to this object
+  /// (starting at offset). Spans of concrete bytes are moved in bulk, only
+  /// symbolic bytes are copied one at a time. If onlyChanged is set, bytes
+  /// that already hold the same value are not written.
+  void copyFrom(unsigned offset, const ObjectState &src, unsigned srcOffset,
+                unsigned count, bool onlyChanged = false);
+
+  /// Whether count bytes of src (starting at srcOffset) hold the same values
+  /// as this object (starting at offset), so copyFrom with onlyChanged set
+  /// would write nothing.
+  bool isRangeEqual(unsigned offset, const ObjectState &src,
+                    unsigned srcOffset, unsigned count) const;
+
   void print() const;
 
   /*
@@ -304,6 +404,21 @@ public:
 
   bool isSegment() const;
 
+  /* the address arrays that may be stored in this object */
+  void getPointedArrays(std::set<uint64_t> &ids) const;
+
+  /* the observed windows of symbolic reads and writes */
+  void getAccessWindows(std::vector<AccessWindow> &windows) const;
+
+  /* the window a symbolic access may touch, computed by the range analysis
+     whether or not --use-offset-range-analysis trusts it for flushing */
+  void getAccessWindow(ref<Expr> offset, unsigned bytes,
+                       unsigned &base, unsigned &size) const;
+
+  /* counts an access in the histogram, done by the flushes and for accesses
+     that are not performed because the object is split first */
+  void recordAccess(unsigned base, unsigned size) const;
+
   const Array *getArray() {
     return updates.root;
   }
@@ -319,8 +434,19 @@ private:
   void write8(unsigned offset, ref<Expr> value);
   void write8(ref<Expr> offset, ref<Expr> value);
 
-  void fastRangeCheckOffset(ref<Expr> offset, unsigned *base_r, 
-                            unsigned *size_r) const;
+  void writeConcreteRange(unsigned offset, const uint8_t *values,
+                          unsigned count);
+  bool isRangeConcrete(unsigned offset, unsigned count) const;
+
+  void updatePointers(unsigned offset, ref<Expr> value);
+  void copyPointers(unsigned offset, const ObjectState &src,
+                    unsigned srcOffset, unsigned count);
+
+  void flushForRead(ref<Expr> offset, unsigned bytes = 1) const;
+  void flushForWrite(ref<Expr> offset, unsigned bytes = 1);
+
+  void fastRangeCheckOffset(ref<Expr> offset, unsigned bytes,
+                            unsigned *base_r, unsigned *size_r) const;
   void flushRangeForRead(unsigned rangeBase, unsigned rangeSize) const;
   void flushRangeForWrite(unsigned rangeBase, unsigned rangeSize);
 
@@ -334,6 +460,8 @@ private:
   void markByteUnflushed(unsigned offset);
   void setKnownSymbolic(unsigned offset, Expr *value);
 
+  void markChanged() const { version = ++lastVersion; }
+
   ArrayCache *getArrayCache() const;
 };
   
@@ -56,16 +56,40 @@ llvm::cl::opt<unsigned long long> DeterministicStartAddress(
                    "aligned (default=0x7ff30000000)"),
     llvm::cl::init(0x7ff30000000), llvm::cl::cat(MemoryCat));
 
-llvm::cl::opt<bool> LocalAddressSpace("local-address-space",
-                                      llvm::cl::desc(""),
-                                      llvm::cl::init(false));
+llvm::cl::opt<bool> LocalAddressSpace(
+    "local-address-space",
+    llvm::cl::desc("Allocate the objects of each state from its own arena, "
+                   "forked states continue from the addresses of their "
+                   "parent (requires --allocate-determ) (default=false)"),
+    llvm::cl::init(false), llvm::cl::cat(MemoryCat));
+
+llvm::cl::opt<bool> ReuseLocalAddresses(
+    "reuse-local-addresses",
+    llvm::cl::desc("With --local-address-space, reuse the addresses of freed "
+                   "objects and popped stack frames. A use after free or "
+                   "after return then accesses the new object instead of "
+                   "being reported (default=false)"),
+    llvm::cl::init(false), llvm::cl::cat(MemoryCat));
+
+llvm::cl::opt<unsigned> LocalArenaSize(
+    "local-arena-size",
+    llvm::cl::desc("Size of the arenas reserved when a local address space "
+                   "runs out of space, in MB (default=16)"),
+    llvm::cl::init(16), llvm::cl::cat(MemoryCat));
 
 } // namespace
 
+/***/
+Arena::~Arena() {
+  if (owned)
+    munmap(base, size);
+}
+
 /***/
 MemoryManager::MemoryManager(ArrayCache *_arrayCache)
     : arrayCache(_arrayCache), deterministicSpace(0), nextFreeSlot(0),
-      spaceSize(DeterministicAllocationSize.getValue() * 1024 * 1024) {
+      spaceSize(DeterministicAllocationSize.getValue() * 1024 * 1024),
+      arenaCount(0) {
   if (DeterministicAllocation) {
     // Page boundary
     void *expectedAddress = (void *)DeterministicStartAddress.getValue();
@@ -84,6 +108,7 @@ MemoryManager::MemoryManager(ArrayCache *_arrayCache)
     klee_message("Deterministic memory allocation starting from %p", newSpace);
     deterministicSpace = newSpace;
     nextFreeSlot = newSpace;
+    mainArena = new Arena(deterministicSpace, spaceSize, false);
   }
 }
 
@@ -104,7 +129,7 @@ MemoryObject *MemoryManager::allocate(uint64_t size, bool isLocal,
                                       bool isGlobal,
                                       const llvm::Value *allocSite,
                                       size_t alignment,
-                                      char **local_next_slot) {
+                                      LocalSpace *localSpace) {
   if (size > 10 * 1024 * 1024)
     klee_warning_once(0, "Large alloc: %" PRIu64
                          " bytes.  KLEE may run out of memory.",
@@ -120,29 +145,8 @@ MemoryObject *MemoryManager::allocate(uint64_t size, bool isLocal,
   }
 
   uint64_t address = 0;
-  char *next = LocalAddressSpace ? *local_next_slot : nextFreeSlot;
-  if (!next) {
-    next = deterministicSpace;
-  }
-
   if (DeterministicAllocation) {
-#if LLVM_VERSION_CODE >= LLVM_VERSION(3, 9)
-    address = llvm::alignTo((uint64_t)(next) + alignment - 1, alignment);
-#else
-    address = llvm::RoundUpToAlignment((uint64_t)(next) + alignment - 1, alignment);
-#endif
-
-    // Handle the case of 0-sized allocations as 1-byte allocations.
-    // This way, we make sure we have this allocation between its own red zones
-    size_t alloc_size = std::max(size, (uint64_t)1);
-    if ((char *)(address) + alloc_size < deterministicSpace + spaceSize) {
-      next = (char *)(address) + alloc_size + RedzoneSize;
-    } else {
-      klee_warning_once(0, "Couldn't allocate %" PRIu64
-                           " bytes. Not enough deterministic space left.",
-                        size);
-      address = 0;
-    }
+    address = allocateDeterministic(size, alignment, localSpace);
   } else {
     // Use malloc for the standard case
     if (alignment <= 8)
@@ -156,12 +160,6 @@ MemoryObject *MemoryManager::allocate(uint64_t size, bool isLocal,
     }
   }
 
-  if (LocalAddressSpace) {
-    *local_next_slot = next;
-  } else {
-    nextFreeSlot = next;
-  }
-
   if (!address)
     return 0;
 
@@ -199,7 +197,7 @@ bool MemoryManager::allocateWithPartition(std::vector<uint64_t> partition,
                                           bool isGlobal,
                                           const llvm::Value *allocSite,
                                           size_t alignment,
-                                          char **local_next_slot,
+                                          LocalSpace *localSpace,
                                           std::vector<const MemoryObject *> &result) {
   uint64_t total_size = 0;
   for (uint64_t mo_size : partition) {
@@ -220,23 +218,9 @@ bool MemoryManager::allocateWithPartition(std::vector<uint64_t> partition,
   }
 
   uint64_t address = 0;
-  char *next = LocalAddressSpace ? *local_next_slot : nextFreeSlot;
-
   if (DeterministicAllocation) {
-#if LLVM_VERSION_CODE >= LLVM_VERSION(3, 9)
-    address = llvm::alignTo((uint64_t)(next) + alignment - 1, alignment);
-#else
-    address = llvm::RoundUpToAlignment((uint64_t)(next) + alignment - 1,
-                                       alignment);
-#endif
-
-    size_t alloc_size = std::max(total_size, (uint64_t)(1));
-    if ((char *)(address) + alloc_size < deterministicSpace + spaceSize) {
-      next = (char *)(address) + alloc_size + RedzoneSize;
-    } else {
-      klee_warning_once(0, "Couldn't allocate %" PRIu64 " bytes. Not enough deterministic space left.", total_size);
-      address = 0;
-    }
+    /* the partition is not reused as a whole when freed */
+    address = allocateDeterministic(total_size, alignment, localSpace);
   } else {
     if (alignment <= 8) {
       address = (uint64_t)(malloc(total_size));
@@ -249,12 +233,6 @@ bool MemoryManager::allocateWithPartition(std::vector<uint64_t> partition,
     }
   }
 
-  if (LocalAddressSpace) {
-    *local_next_slot = next;
-  } else {
-    nextFreeSlot = next;
-  }
-
   if (!address) {
     return false;
   }
@@ -279,16 +257,177 @@ bool MemoryManager::allocateWithPartition(std::vector<uint64_t> partition,
   return true;
 }
 
+MemoryObject *MemoryManager::allocateMerged(const std::vector<const MemoryObject *> &parts) {
+  assert(!parts.empty());
+  const MemoryObject *first = parts.front();
+  uint64_t size = 0;
+  for (const MemoryObject *mo : parts) {
+    assert(mo->address == first->address + size && "parts are not adjacent");
+    size += mo->size;
+  }
+
+  ++stats::allocations;
+  MemoryObject *mo = new MemoryObject(first->address,
+                                      size,
+                                      first->isLocal,
+                                      first->isGlobal,
+                                      false,
+                                      false,
+                                      first->allocSite,
+                                      this);
+  objects.insert(mo);
+  return mo;
+}
+
 void MemoryManager::deallocate(const MemoryObject *mo) { assert(0); }
 
 void MemoryManager::markFreed(MemoryObject *mo) {
   if (objects.find(mo) != objects.end()) {
+    clearNativeContents(mo);
     if (!mo->isFixed && mo->canFree && !DeterministicAllocation)
       free((void *)mo->address);
     objects.erase(mo);
   }
 }
 
+bool MemoryManager::hasNativeContents(const MemoryObject *mo,
+                                      uint64_t version) const {
+  auto i = nativeContents.find(mo->address);
+  return i != nativeContents.end() &&
+         i->second.end == mo->address + mo->size &&
+         i->second.id == mo->id &&
+         i->second.version == version;
+}
+
+void MemoryManager::setNativeContents(const MemoryObject *mo,
+                                      uint64_t version) {
+  forgetNativeContents(mo->address, mo->size);
+  nativeContents.insert(std::make_pair(
+      mo->address, NativeContents(mo->address + mo->size, mo->id, version)));
+}
+
+void MemoryManager::clearNativeContents(const MemoryObject *mo) {
+  auto i = nativeContents.find(mo->address);
+  if (i != nativeContents.end() && i->second.id == mo->id) {
+    nativeContents.erase(i);
+  }
+}
+
+void MemoryManager::forgetNativeContents(uint64_t address, uint64_t size) {
+  uint64_t end = address + size;
+  auto i = nativeContents.upper_bound(address);
+  if (i != nativeContents.begin()) {
+    auto prev = std::prev(i);
+    if (prev->second.end > address || prev->first == address) {
+      nativeContents.erase(prev);
+    }
+  }
+  while (i != nativeContents.end() && i->first < end) {
+    i = nativeContents.erase(i);
+  }
+}
+
+void MemoryManager::markFreedLocal(const MemoryObject *mo,
+                                   LocalSpace *localSpace) {
+  if (!LocalAddressSpace || !ReuseLocalAddresses || !DeterministicAllocation ||
+      mo->isFixed) {
+    return;
+  }
+
+  localSpace->freed[std::max((uint64_t)mo->size, (uint64_t)1)].push_back(mo->address);
+}
+
+ref<Arena> MemoryManager::createArena(uint64_t minSize) {
+  size_t size = std::max((uint64_t)LocalArenaSize * 1024 * 1024,
+                         minSize + RedzoneSize);
+  size = (size + 4095) & ~(size_t)4095;
+
+  /* place the arenas after the deterministic space if possible */
+  char *hint = deterministicSpace + spaceSize +
+               (uint64_t)(++arenaCount) * LocalArenaSize * 1024 * 1024;
+  char *base = (char *)mmap(hint, size, PROT_READ | PROT_WRITE,
+                            MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    return nullptr;
+  }
+
+  klee_message("Reserved arena of %zu bytes at %p", size, base);
+  return new Arena(base, size, true);
+}
+
+uint64_t MemoryManager::allocateDeterministic(uint64_t size,
+                                              size_t alignment,
+                                              LocalSpace *localSpace) {
+  // Handle the case of 0-sized allocations as 1-byte allocations.
+  // This way, we make sure we have this allocation between its own red zones
+  size_t alloc_size = std::max(size, (uint64_t)1);
+
+  if (LocalAddressSpace) {
+    /* reuse an address freed by this state */
+    auto i = localSpace->freed.find(alloc_size);
+    if (i != localSpace->freed.end()) {
+      std::vector<uint64_t> &addresses = i->second;
+      for (auto j = addresses.rbegin(); j != addresses.rend(); ++j) {
+        if (*j % alignment == 0) {
+          uint64_t address = *j;
+          addresses.erase(std::next(j).base());
+          if (addresses.empty()) {
+            localSpace->freed.erase(i);
+          }
+          return address;
+        }
+      }
+    }
+
+    if (localSpace->arenas.empty()) {
+      localSpace->arenas.push_back(mainArena);
+      localSpace->next = deterministicSpace;
+    }
+  }
+
+  for (unsigned attempt = 0; attempt < 2; attempt++) {
+    char *next = LocalAddressSpace ? localSpace->next : nextFreeSlot;
+    char *begin = LocalAddressSpace ? localSpace->arenas.back()->base : deterministicSpace;
+    char *end = LocalAddressSpace ? begin + localSpace->arenas.back()->size : deterministicSpace + spaceSize;
+    if (!next) {
+      next = begin;
+    }
+
+#if LLVM_VERSION_CODE >= LLVM_VERSION(3, 9)
+    uint64_t address = llvm::alignTo((uint64_t)(next) + alignment - 1, alignment);
+#else
+    uint64_t address = llvm::RoundUpToAlignment((uint64_t)(next) + alignment - 1, alignment);
+#endif
+
+    if ((char *)(address) + alloc_size < end) {
+      next = (char *)(address) + alloc_size + RedzoneSize;
+      if (LocalAddressSpace) {
+        localSpace->next = next;
+      } else {
+        nextFreeSlot = next;
+      }
+      return address;
+    }
+
+    if (!LocalAddressSpace || attempt != 0) {
+      break;
+    }
+
+    /* the current arena is exhausted, continue in a fresh one */
+    ref<Arena> arena = createArena(alloc_size + alignment);
+    if (arena.isNull()) {
+      break;
+    }
+    localSpace->arenas.push_back(arena);
+    localSpace->next = arena->base;
+  }
+
+  klee_warning_once(0, "Couldn't allocate %" PRIu64
+                       " bytes. Not enough deterministic space left.",
+                    size);
+  return 0;
+}
+
 size_t MemoryManager::getUsedDeterministicSize() {
   return nextFreeSlot - deterministicSpace;
 }
@@ -10,9 +10,13 @@
 #ifndef KLEE_MEMORYMANAGER_H
 #define KLEE_MEMORYMANAGER_H
 
+#include "klee/util/Ref.h"
+
 #include <cstddef>
+#include <map>
 #include <set>
 #include <cstdint>
+#include <vector>
 
 namespace llvm {
 class Value;
@@ -22,6 +26,49 @@ namespace klee {
 class MemoryObject;
 class ArrayCache;
 
+/* a region of the deterministic space, shared by a family of states */
+class Arena {
+public:
+  char *base;
+  size_t size;
+  /* whether the region was mapped for this arena (and unmapped with it) */
+  bool owned;
+  mutable unsigned refCount;
+
+  Arena(char *base, size_t size, bool owned) :
+    base(base), size(size), owned(owned), refCount(0) {
+
+  }
+
+  ~Arena();
+};
+
+/* the allocation state of a state in --local-address-space mode */
+struct LocalSpace {
+  char *next;
+  /* the arenas holding the objects of the state, the last one is current */
+  std::vector<ref<Arena>> arenas;
+  /* size -> addresses freed by the state, reused by later allocations
+     (with --reuse-local-addresses) */
+  std::map<uint64_t, std::vector<uint64_t>> freed;
+
+  LocalSpace() : next(nullptr) {
+
+  }
+};
+
+/* the object whose contents were last copied to a range of native memory */
+struct NativeContents {
+  uint64_t end;
+  unsigned id;
+  uint64_t version;
+
+  NativeContents(uint64_t end, unsigned id, uint64_t version) :
+    end(end), id(id), version(version) {
+
+  }
+};
+
 class MemoryManager {
 private:
   typedef std::set<MemoryObject *> objects_ty;
@@ -32,6 +79,19 @@ private:
   char *nextFreeSlot;
   size_t spaceSize;
 
+  /* the deterministic space, as the first arena of local address spaces */
+  ref<Arena> mainArena;
+  unsigned arenaCount;
+
+  uint64_t allocateDeterministic(uint64_t size, size_t alignment,
+                                 LocalSpace *localSpace);
+  ref<Arena> createArena(uint64_t minSize);
+
+  /* start address -> contents, the ranges are disjoint */
+  std::map<uint64_t, NativeContents> nativeContents;
+
+  void forgetNativeContents(uint64_t address, uint64_t size);
+
 public:
   MemoryManager(ArrayCache *arrayCache);
   ~MemoryManager();
@@ -41,7 +101,7 @@ public:
    * memory.
    */
   MemoryObject *allocate(uint64_t size, bool isLocal, bool isGlobal,
-                         const llvm::Value *allocSite, size_t alignment, char **local_next_slot);
+                         const llvm::Value *allocSite, size_t alignment, LocalSpace *localSpace);
   MemoryObject *allocateFixed(uint64_t address, uint64_t size,
                               const llvm::Value *allocSite);
   bool allocateWithPartition(std::vector<uint64_t> partition,
@@ -49,13 +109,25 @@ public:
                              bool isGlobal,
                              const llvm::Value *allocSite,
                              size_t alignment,
-                             char **local_next_slot,
+                             LocalSpace *localSpace,
                              std::vector<const MemoryObject *> &result);
+  /* an object covering the given adjacent objects (from allocateWithPartition),
+     the memory is not allocated again */
+  MemoryObject *allocateMerged(const std::vector<const MemoryObject *> &parts);
 
   void deallocate(const MemoryObject *mo);
   void markFreed(MemoryObject *mo);
+  /* the object was freed by a state, its address can be reused by it */
+  void markFreedLocal(const MemoryObject *mo, LocalSpace *localSpace);
   ArrayCache *getArrayCache() const { return arrayCache; }
 
+  /* whether the native memory of the object holds the given version of its
+     contents (see ObjectState::version) */
+  bool hasNativeContents(const MemoryObject *mo, uint64_t version) const;
+  void setNativeContents(const MemoryObject *mo, uint64_t version);
+  /* the native memory of the object may hold anything */
+  void clearNativeContents(const MemoryObject *mo);
+
   /*
    * Returns the size used by deterministic allocation in bytes
    */
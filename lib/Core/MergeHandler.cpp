@@ -96,6 +96,7 @@ void MergeHandler::addClosedState(ExecutionState *es,
   if (closePoint == reachedCloseMerge.end()) {
     reachedCloseMerge[mp].push_back(es);
     executor->pauseState(*es);
+    parkState(es, mp);
   } else {
     // Otherwise try to merge with any state in the map element for this
     // instruction
@@ -103,7 +104,13 @@ void MergeHandler::addClosedState(ExecutionState *es,
     bool mergedSuccessful = false;
 
     for (auto& mState: cpv) {
-      if (mState->merge(*es)) {
+      // only the state that takes the merge needs its constraints back
+      if (!mState->canMerge(*es))
+        continue;
+      mState->unpark();
+      bool merged = mState->merge(*es);
+      parkState(mState, mp);
+      if (merged) {
         executor->terminateState(*es);
         executor->inCloseMerge.erase(es);
         mergedSuccessful = true;
@@ -113,18 +120,28 @@ void MergeHandler::addClosedState(ExecutionState *es,
     if (!mergedSuccessful) {
       cpv.push_back(es);
       executor->pauseState(*es);
+      parkState(es, mp);
     }
   }
 }
 
+void MergeHandler::parkState(ExecutionState *es, llvm::Instruction *mp) {
+  auto &base = parkBases[mp];
+  if (!base)
+    base = std::make_shared<ParkBase>();
+  es->park(*base);
+}
+
 void MergeHandler::releaseStates() {
   for (auto& curMergeGroup: reachedCloseMerge) {
     for (auto curState: curMergeGroup.second) {
+      curState->unpark();
       executor->continueState(*curState);
       executor->inCloseMerge.erase(curState);
     }
   }
   reachedCloseMerge.clear();
+  parkBases.clear();
 }
 
 bool MergeHandler::hasMergedStates() {
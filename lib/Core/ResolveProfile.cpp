@@ -0,0 +1,165 @@
+//===-- ResolveProfile.cpp ------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ResolveProfile.h"
+
+#include "klee/ExecutionState.h"
+#include "klee/Internal/Module/InstructionInfoTable.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+using namespace klee;
+
+bool ResolveProfile::load(const std::string &path, std::string &error) {
+  std::ifstream in(path.c_str());
+  if (!in) {
+    error = "unable to open " + path;
+    return false;
+  }
+
+  std::string line;
+  unsigned lineNo = 0;
+  while (std::getline(in, line)) {
+    lineNo++;
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    std::istringstream ss(line);
+    std::string kind;
+    uint64_t id;
+    if (!(ss >> kind >> id)) {
+      error = "malformed record at line " + std::to_string(lineNo);
+      return false;
+    }
+
+    std::vector<uint64_t> hashes;
+    uint64_t hash;
+    while (ss >> hash) {
+      hashes.push_back(hash);
+    }
+
+    if (kind == "resolve") {
+      for (uint64_t h : hashes) {
+        addResolved(id, AllocationContext(h));
+      }
+    } else if (kind == "rebase") {
+      addRebase(id, hashes);
+    } else {
+      error = "unknown record '" + kind + "' at line " + std::to_string(lineNo);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void ResolveProfile::save(llvm::raw_ostream &os) const {
+  os << "# klee resolve profile\n";
+  for (auto &i : resolved) {
+    os << "resolve " << i.first;
+    for (const AllocationContext &ac : i.second) {
+      os << " " << ac.hash;
+    }
+    os << "\n";
+  }
+  for (const RebaseRecord &r : rebases) {
+    os << "rebase " << r.first;
+    for (uint64_t h : r.second) {
+      os << " " << h;
+    }
+    os << "\n";
+  }
+}
+
+void ResolveProfile::addResolved(uint64_t id, const AllocationContext &ac) {
+  std::vector<AllocationContext> &contexts = resolved[id];
+  for (const AllocationContext &other : contexts) {
+    if (other.hash == ac.hash) {
+      return;
+    }
+  }
+  contexts.push_back(ac);
+}
+
+void ResolveProfile::addRebase(const RebaseID &rid) {
+  std::vector<uint64_t> hashes;
+  for (const AllocationContext &ac : rid.getContexts()) {
+    hashes.push_back(ac.hash);
+  }
+  addRebase(rid.getInfo()->id, hashes);
+}
+
+void ResolveProfile::addRebase(uint64_t id, const std::vector<uint64_t> &hashes) {
+  std::vector<uint64_t> sorted;
+  for (uint64_t h : hashes) {
+    /* the empty context is shared by unrelated allocations, ignore it */
+    if (h != 0) {
+      sorted.push_back(h);
+    }
+  }
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  if (sorted.empty()) {
+    return;
+  }
+
+  if (!rebases.insert(std::make_pair(id, sorted)).second) {
+    return;
+  }
+
+  /* contexts merged by the same rebase end up in the same group */
+  uint64_t root = findGroup(sorted[0]);
+  for (uint64_t h : sorted) {
+    uint64_t other = findGroup(h);
+    if (other != root) {
+      groups[other] = root;
+    }
+  }
+}
+
+uint64_t ResolveProfile::findGroup(uint64_t hash) {
+  auto i = groups.find(hash);
+  if (i == groups.end()) {
+    groups[hash] = hash;
+    return hash;
+  }
+
+  if (i->second == hash) {
+    return hash;
+  }
+
+  uint64_t root = findGroup(i->second);
+  groups[hash] = root;
+  return root;
+}
+
+bool ResolveProfile::getGroup(const AllocationContext &ac,
+                              uint64_t &group) const {
+  if (ac.hash == 0) {
+    return false;
+  }
+
+  auto i = groups.find(ac.hash);
+  if (i == groups.end()) {
+    return false;
+  }
+
+  /* follow the representatives without path compression */
+  uint64_t current = ac.hash;
+  while (i->second != current) {
+    current = i->second;
+    i = groups.find(current);
+  }
+
+  group = current;
+  return true;
+}
@@ -0,0 +1,69 @@
+//===-- ResolveProfile.h ----------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_RESOLVEPROFILE_H
+#define KLEE_RESOLVEPROFILE_H
+
+#include "AllocationContext.h"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace klee {
+
+class RebaseID;
+
+/// Resolution and rebase outcomes collected in a previous run. Allocation
+/// contexts which were merged into the same segment are grouped together,
+/// so that later runs can place them in a shared segment at allocation time.
+class ResolveProfile {
+public:
+  /* instruction id -> allocation contexts resolved at that instruction */
+  std::map<uint64_t, std::vector<AllocationContext>> resolved;
+
+  ResolveProfile() {
+
+  }
+
+  bool load(const std::string &path, std::string &error);
+
+  void save(llvm::raw_ostream &os) const;
+
+  void addResolved(uint64_t id, const AllocationContext &ac);
+
+  void addRebase(const RebaseID &rid);
+
+  /* returns the group of the allocation context (if known) */
+  bool getGroup(const AllocationContext &ac, uint64_t &group) const;
+
+  bool empty() const {
+    return groups.empty();
+  }
+
+private:
+  typedef std::pair<uint64_t, std::vector<uint64_t>> RebaseRecord;
+
+  void addRebase(uint64_t id, const std::vector<uint64_t> &hashes);
+
+  uint64_t findGroup(uint64_t hash);
+
+  /* rebase outcomes: instruction id and the merged allocation contexts */
+  std::set<RebaseRecord> rebases;
+
+  /* allocation context hash -> group representative (union-find) */
+  std::map<uint64_t, uint64_t> groups;
+};
+
+}
+
+#endif /* KLEE_RESOLVEPROFILE_H */
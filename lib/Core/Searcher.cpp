@@ -176,6 +176,7 @@ WeightedRandomSearcher::WeightedRandomSearcher(WeightType _type)
   case QueryCost:
   case MinDistToUncovered:
   case CoveringNew:
+  case RelocationCost:
     updateWeights = true;
     break;
   default:
@@ -210,6 +211,17 @@ double WeightedRandomSearcher::getWeight(ExecutionState *es) {
   }
   case QueryCost:
     return (es->queryCost.toSeconds() < .1) ? 1. : 1./ es->queryCost.toSeconds();
+  case RelocationCost: {
+    /* states that went through many rebases carry larger rewritten
+       constraints and more address arrays, so each query is more expensive */
+    double cost = 1. + es->rewrittenConstraints.size() +
+                  es->getAddressConstraints().size() +
+                  es->getHistory().size();
+    double inv = 1. / cost;
+    if (es->queryCost.toSeconds() >= .1)
+      inv /= es->queryCost.toSeconds();
+    return inv;
+  }
   case CoveringNew:
   case MinDistToUncovered: {
     uint64_t md2u = computeMinDistToUncovered(es->pc,
@@ -79,7 +79,8 @@ namespace klee {
       NURS_Depth,
       NURS_ICnt,
       NURS_CPICnt,
-      NURS_QC
+      NURS_QC,
+      NURS_RC
     };
   };
 
@@ -133,7 +134,8 @@ namespace klee {
       InstCount,
       CPInstCount,
       MinDistToUncovered,
-      CoveringNew
+      CoveringNew,
+      RelocationCost
     };
 
   private:
@@ -161,6 +163,7 @@ namespace klee {
       case CPInstCount        : os << "CPInstCount\n"; return;
       case MinDistToUncovered : os << "MinDistToUncovered\n"; return;
       case CoveringNew        : os << "CoveringNew\n"; return;
+      case RelocationCost     : os << "RelocationCost\n"; return;
       default                 : os << "<unknown type>\n"; return;
       }
     }
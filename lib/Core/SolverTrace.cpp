@@ -0,0 +1,139 @@
+//===-- SolverTrace.cpp ---------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "SolverTrace.h"
+
+#include "klee/ExecutionState.h"
+#include "klee/SolverStats.h"
+#include "klee/Internal/Module/InstructionInfoTable.h"
+#include "klee/Internal/Module/KInstruction.h"
+#include "klee/Internal/Support/ErrorHandling.h"
+
+#include <chrono>
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+using namespace klee;
+
+namespace {
+  const char TraceMagic[8] = {'K', 'L', 'E', 'E', 'S', 'T', 'R', 'C'};
+  const uint32_t TraceVersion = 1;
+
+  /// Number of distinct nodes in the expression DAG.
+  unsigned countNodes(ref<Expr> e) {
+    std::unordered_set<const Expr *> visited;
+    std::vector<const Expr *> stack(1, e.get());
+    while (!stack.empty()) {
+      const Expr *current = stack.back();
+      stack.pop_back();
+      if (!visited.insert(current).second)
+        continue;
+      for (unsigned i = 0; i != current->getNumKids(); ++i)
+        stack.push_back(current->getKid(i).get());
+    }
+    return visited.size();
+  }
+}
+
+SolverTrace::SolverTrace(std::unique_ptr<llvm::raw_fd_ostream> _os)
+  : os(std::move(_os)), buffer(Capacity), opened(time::getWallTime()),
+    dropped(0), done(false) {
+  SolverTraceHeader header;
+  std::memcpy(header.magic, TraceMagic, sizeof(header.magic));
+  header.version = TraceVersion;
+  header.recordSize = sizeof(SolverTraceRecord);
+  os->write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  writer = std::thread(&SolverTrace::run, this);
+}
+
+SolverTrace::~SolverTrace() {
+  done.store(true, std::memory_order_release);
+  writer.join();
+
+  if (dropped)
+    klee_warning("solver trace: dropped %llu records, the writer fell behind",
+                 (unsigned long long) dropped);
+}
+
+void SolverTrace::run() {
+  std::vector<SolverTraceRecord> batch(BatchSize);
+  for (;;) {
+    // Read the flag before draining, so that everything pushed before the
+    // destructor ran is written out.
+    bool stopping = done.load(std::memory_order_acquire);
+    size_t n = buffer.pop(batch.data(), batch.size());
+    if (n) {
+      os->write(reinterpret_cast<const char *>(batch.data()),
+                n * sizeof(SolverTraceRecord));
+      continue;
+    }
+    if (stopping)
+      break;
+    os->flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  os->flush();
+}
+
+SolverTrace::Start SolverTrace::start() const {
+  Start s;
+  s.queries = stats::queries.getValue();
+  s.cexCacheHits = stats::queryCexCacheHits.getValue();
+  s.cacheHits = stats::queryCacheHits.getValue();
+  s.time = time::getWallTime();
+  return s;
+}
+
+void SolverTrace::push(const ExecutionState &state, Kind kind, Layer layer,
+                       const time::Point &now, const time::Span &wallTime,
+                       unsigned nodes, int result, bool success) {
+  SolverTraceRecord r;
+  r.timestamp = (now - opened).toMicroseconds();
+  r.wallTime = wallTime.toMicroseconds();
+  KInstruction *ki = state.prevPC;
+  r.instruction = ki ? ki->info->id : 0;
+  r.line = ki ? ki->info->line : 0;
+  r.constraints = state.rewrittenConstraints.size();
+  r.nodes = nodes;
+  r.kind = kind;
+  r.layer = layer;
+  r.result = result;
+  r.success = success;
+  r.reserved = 0;
+
+  if (!buffer.push(r))
+    ++dropped;
+}
+
+void SolverTrace::record(const ExecutionState &state, Kind kind,
+                         const Start &start, ref<Expr> expr, bool success,
+                         int result) {
+  time::Point now = time::getWallTime();
+
+  // Each layer only bumps its own counter when it answers, so the innermost
+  // counter that moved tells how far the query went down the chain.
+  Layer layer = Other;
+  if (stats::queries.getValue() != start.queries)
+    layer = CoreSolver;
+  else if (stats::queryCexCacheHits.getValue() != start.cexCacheHits)
+    layer = CexCache;
+  else if (stats::queryCacheHits.getValue() != start.cacheHits)
+    layer = QueryCache;
+
+  push(state, kind, layer, now, now - start.time, countNodes(expr), result,
+       success);
+}
+
+void SolverTrace::recordConstant(const ExecutionState &state, Kind kind,
+                                 int result) {
+  push(state, kind, Constant, time::getWallTime(), time::Span(), 1, result,
+       true);
+}
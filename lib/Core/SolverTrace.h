@@ -0,0 +1,115 @@
+//===-- SolverTrace.h -------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_SOLVERTRACE_H
+#define KLEE_SOLVERTRACE_H
+
+#include "klee/Expr.h"
+#include "klee/Internal/ADT/RingBuffer.h"
+#include "klee/Internal/System/Time.h"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace klee {
+  class ExecutionState;
+
+  /// One solver call. The trace file is a SolverTraceHeader followed by
+  /// these records, both in host byte order. tools/klee-solver-trace reads
+  /// this layout, keep them in sync.
+  struct SolverTraceRecord {
+    uint64_t timestamp;   // µs since the trace was opened
+    uint64_t wallTime;    // µs spent in the call
+    uint32_t instruction; // InstructionInfo id of the caller
+    uint32_t line;        // source line of the caller
+    uint32_t constraints; // constraints sent along with the query
+    uint32_t nodes;       // distinct nodes of the query expression
+    uint8_t kind;         // SolverTrace::Kind
+    uint8_t layer;        // SolverTrace::Layer
+    int8_t result;        // validity for evaluate, 0/1 for mustBeTrue
+    uint8_t success;
+    uint32_t reserved;
+  };
+
+  static_assert(sizeof(SolverTraceRecord) == 40,
+                "solver trace record layout changed");
+
+  struct SolverTraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+  };
+
+  /// Records every query issued through the TimingSolver into a lock-free
+  /// ring buffer. A background thread drains the buffer into the trace
+  /// file, so the interpreter never blocks on I/O. When the writer falls
+  /// behind, records are dropped and counted instead.
+  class SolverTrace {
+  public:
+    enum Kind { Evaluate, MustBeTrue, GetValue, GetInitialValues };
+
+    /// The part of the solver chain that answered a query, derived from
+    /// the solver statistics that changed during the call.
+    enum Layer {
+      Constant,   // folded before reaching the solver chain
+      QueryCache, // CachingSolver
+      CexCache,   // CexCachingSolver
+      CoreSolver,
+      Other       // answered elsewhere in the chain, e.g. trivially
+    };
+
+    struct Start {
+      time::Point time;
+      uint64_t queries;
+      uint64_t cexCacheHits;
+      uint64_t cacheHits;
+    };
+
+  private:
+    static const size_t Capacity = 1 << 16;
+    static const size_t BatchSize = 1024;
+
+    std::unique_ptr<llvm::raw_fd_ostream> os;
+    RingBuffer<SolverTraceRecord> buffer;
+    time::Point opened;
+    uint64_t dropped;
+
+    std::atomic<bool> done;
+    std::thread writer;
+
+    void run();
+    void push(const ExecutionState &state, Kind kind, Layer layer,
+              const time::Point &now, const time::Span &wallTime,
+              unsigned nodes, int result, bool success);
+
+  public:
+    explicit SolverTrace(std::unique_ptr<llvm::raw_fd_ostream> os);
+    /// Stops the writer after it has flushed all pending records.
+    ~SolverTrace();
+
+    SolverTrace(const SolverTrace &) = delete;
+    SolverTrace &operator=(const SolverTrace &) = delete;
+
+    /// Called right before a query is passed to the solver chain.
+    Start start() const;
+
+    void record(const ExecutionState &state, Kind kind, const Start &start,
+                ref<Expr> expr, bool success, int result);
+
+    /// A query that folded to a constant and never reached the solver.
+    void recordConstant(const ExecutionState &state, Kind kind, int result);
+  };
+
+}
+
+#endif /* KLEE_SOLVERTRACE_H */
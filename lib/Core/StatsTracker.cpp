@@ -310,10 +310,36 @@ StatsTracker::StatsTracker(Executor &_executor, std::string _objectFilename,
     } else {
       klee_error("Unable to open instruction level stats file (run.istats).");
     }
+
+    StatisticManager &sm = *theStatisticManager;
+    // The mask has room for 64 statistics
+    assert(sm.getNumStatistics() <= 64 &&
+           "too many statistics for the istats mask");
+    istatsMask |= 1ULL<<sm.getStatisticID("Queries");
+    istatsMask |= 1ULL<<sm.getStatisticID("QueriesValid");
+    istatsMask |= 1ULL<<sm.getStatisticID("QueriesInvalid");
+    istatsMask |= 1ULL<<sm.getStatisticID("QueryTime");
+    istatsMask |= 1ULL<<sm.getStatisticID("ResolveTime");
+    istatsMask |= 1ULL<<sm.getStatisticID("Instructions");
+    istatsMask |= 1ULL<<sm.getStatisticID("InstructionTimes");
+    istatsMask |= 1ULL<<sm.getStatisticID("InstructionRealTimes");
+    istatsMask |= 1ULL<<sm.getStatisticID("Forks");
+    istatsMask |= 1ULL<<sm.getStatisticID("CoveredInstructions");
+    istatsMask |= 1ULL<<sm.getStatisticID("UncoveredInstructions");
+    istatsMask |= 1ULL<<sm.getStatisticID("States");
+    istatsMask |= 1ULL<<sm.getStatisticID("MinDistToUncovered");
+    istatsMask |= 1ULL<<sm.getStatisticID("Rebases");
+    istatsMask |= 1ULL<<sm.getStatisticID("RebaseTime");
+    istatsMask |= 1ULL<<sm.getStatisticID("UnfoldTime");
   }
+
+  if (statsFile || istatsFile)
+    writer = std::thread(&StatsTracker::runWriter, this);
 }
 
 StatsTracker::~StatsTracker() {  
+  stopWriterThread();
+
   if (statsFile) {
     auto rc = sqlite3_step(transactionEndStmt);
     if (rc != SQLITE_DONE) {
@@ -337,6 +363,43 @@ void StatsTracker::done() {
     if (istatsFile)
       writeIStats();
   }
+
+  stopWriterThread();
+}
+
+void StatsTracker::runWriter() {
+  std::unique_lock<std::mutex> lock(writerLock);
+  for (;;) {
+    writerCond.wait(lock, [this] {
+      return stopWriter || !pendingLines.empty() || pendingIStats;
+    });
+    if (pendingLines.empty() && !pendingIStats)
+      return;
+
+    std::deque<StatsLine> lines;
+    lines.swap(pendingLines);
+    std::unique_ptr<IStatsSnapshot> istats = std::move(pendingIStats);
+    lock.unlock();
+
+    for (const auto &line : lines)
+      insertStatsLine(line);
+    if (istats)
+      formatIStats(*istats);
+
+    lock.lock();
+  }
+}
+
+void StatsTracker::stopWriterThread() {
+  if (!writer.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> guard(writerLock);
+    stopWriter = true;
+  }
+  writerCond.notify_one();
+  writer.join();
 }
 
 void StatsTracker::stepInstruction(ExecutionState &es) {
@@ -477,7 +540,21 @@ void StatsTracker::writeStatsHeader() {
 #ifdef KLEE_ARRAY_DEBUG
 	           << "ArrayHashTime INTEGER,"
 #endif
-             << "QueryCexCacheHits INTEGER"
+             << "QueryCexCacheHits INTEGER,"
+             << "RewriteCacheHits INTEGER,"
+             << "RewriteCacheMisses INTEGER,"
+             << "RewriteCacheEvictions INTEGER,"
+             << "Rebases INTEGER,"
+             << "RebasedBytes INTEGER,"
+             << "RebaseTime INTEGER,"
+             << "RebaseCacheHits INTEGER,"
+             << "Splits INTEGER,"
+             << "SplitTime INTEGER,"
+             << "UnfoldTime INTEGER,"
+             << "RewriteTime INTEGER,"
+             << "ParkedStates INTEGER,"
+             << "ParkedBytes INTEGER,"
+             << "ParkedBytesSaved INTEGER"
              << ")";
   char *zErrMsg = nullptr;
   if(sqlite3_exec(statsFile, create.str().c_str(), nullptr, nullptr, &zErrMsg)) {
@@ -513,7 +590,21 @@ void StatsTracker::writeStatsHeader() {
 #ifdef KLEE_ARRAY_DEBUG
              << "ArrayHashTime,"
 #endif
-             << "QueryCexCacheHits "
+             << "QueryCexCacheHits ,"
+             << "RewriteCacheHits ,"
+             << "RewriteCacheMisses ,"
+             << "RewriteCacheEvictions ,"
+             << "Rebases ,"
+             << "RebasedBytes ,"
+             << "RebaseTime ,"
+             << "RebaseCacheHits ,"
+             << "Splits ,"
+             << "SplitTime ,"
+             << "UnfoldTime ,"
+             << "RewriteTime ,"
+             << "ParkedStates ,"
+             << "ParkedBytes ,"
+             << "ParkedBytesSaved "
              << ") VALUES ( "
              << "?, "
              << "?, "
@@ -537,6 +628,20 @@ void StatsTracker::writeStatsHeader() {
 #ifdef KLEE_ARRAY_DEBUG
              << "?, "
 #endif
+             << "?, "
+             << "?, "
+             << "?, "
+             << "?, "
+             << "?, "
+             << "?, "
+             << "?, "
+             << "?, "
+             << "?, "
+             << "?, "
+             << "?, "
+             << "?, "
+             << "?, "
+             << "?, "
              << "? "
              << ")";
 
@@ -550,29 +655,56 @@ time::Span StatsTracker::elapsed() {
 }
 
 void StatsTracker::writeStatsLine() {
-  sqlite3_bind_int64(insertStmt, 1, stats::instructions);
-  sqlite3_bind_int64(insertStmt, 2, fullBranches);
-  sqlite3_bind_int64(insertStmt, 3, partialBranches);
-  sqlite3_bind_int64(insertStmt, 4, numBranches);
-  sqlite3_bind_int64(insertStmt, 5, time::getUserTime().toMicroseconds());
-  sqlite3_bind_int64(insertStmt, 6, executor.states.size());
-  sqlite3_bind_int64(insertStmt, 7, util::GetTotalMallocUsage() + executor.memory->getUsedDeterministicSize());
-  sqlite3_bind_int64(insertStmt, 8, stats::queries);
-  sqlite3_bind_int64(insertStmt, 9, stats::queryConstructs);
-  sqlite3_bind_int64(insertStmt, 10, 0);  // was numObjects
-  sqlite3_bind_int64(insertStmt, 11, elapsed().toMicroseconds());
-  sqlite3_bind_int64(insertStmt, 12, stats::coveredInstructions);
-  sqlite3_bind_int64(insertStmt, 13, stats::uncoveredInstructions);
-  sqlite3_bind_int64(insertStmt, 14, stats::queryTime);
-  sqlite3_bind_int64(insertStmt, 15, stats::solverTime);
-  sqlite3_bind_int64(insertStmt, 16, stats::cexCacheTime);
-  sqlite3_bind_int64(insertStmt, 17, stats::forkTime);
-  sqlite3_bind_int64(insertStmt, 18, stats::resolveTime);
-  sqlite3_bind_int64(insertStmt, 19, stats::queryCexCacheMisses);
-  sqlite3_bind_int64(insertStmt, 20, stats::queryCexCacheHits);
+  StatsLine line;
+  line.reserve(32);
+  line.push_back(stats::instructions);
+  line.push_back(fullBranches);
+  line.push_back(partialBranches);
+  line.push_back(numBranches);
+  line.push_back(time::getUserTime().toMicroseconds());
+  line.push_back(executor.states.size());
+  line.push_back(util::GetTotalMallocUsage() + executor.memory->getUsedDeterministicSize());
+  line.push_back(stats::queries);
+  line.push_back(stats::queryConstructs);
+  line.push_back(0);  // was numObjects
+  line.push_back(elapsed().toMicroseconds());
+  line.push_back(stats::coveredInstructions);
+  line.push_back(stats::uncoveredInstructions);
+  line.push_back(stats::queryTime);
+  line.push_back(stats::solverTime);
+  line.push_back(stats::cexCacheTime);
+  line.push_back(stats::forkTime);
+  line.push_back(stats::resolveTime);
+  line.push_back(stats::queryCexCacheMisses);
+  line.push_back(stats::queryCexCacheHits);
 #ifdef KLEE_ARRAY_DEBUG
-  sqlite3_bind_int64(insertStmt, 21, stats::arrayHashTime);
+  line.push_back(stats::arrayHashTime);
 #endif
+  line.push_back(stats::rewriteCacheHits);
+  line.push_back(stats::rewriteCacheMisses);
+  line.push_back(stats::rewriteCacheEvictions);
+  line.push_back(stats::rebases);
+  line.push_back(stats::rebasedBytes);
+  line.push_back(stats::rebaseTime);
+  line.push_back(stats::rebaseCacheHits);
+  line.push_back(stats::splits);
+  line.push_back(stats::splitTime);
+  line.push_back(stats::unfoldTime);
+  line.push_back(stats::rewriteTime);
+  line.push_back(stats::parkedStates);
+  line.push_back(ExecutionState::getParkedBytes());
+  line.push_back(ExecutionState::getParkedBytesSaved());
+
+  {
+    std::lock_guard<std::mutex> guard(writerLock);
+    pendingLines.push_back(std::move(line));
+  }
+  writerCond.notify_one();
+}
+
+void StatsTracker::insertStatsLine(const StatsLine &line) {
+  for (unsigned i = 0; i < line.size(); ++i)
+    sqlite3_bind_int64(insertStmt, i + 1, line[i]);
   int errCode = sqlite3_step(insertStmt);
   if(errCode != SQLITE_DONE) klee_error("Error writing stats data: %s", sqlite3_errmsg(statsFile));
   sqlite3_reset(insertStmt);
@@ -602,8 +734,29 @@ void StatsTracker::updateStateStatistics(uint64_t addend) {
 }
 
 void StatsTracker::writeIStats() {
+  std::unique_ptr<IStatsSnapshot> snapshot(new IStatsSnapshot());
+
+  // set state counts, decremented after we copied them so that we don't
+  // have to zero all records each time.
+  if (istatsMask & (1ULL<<stats::states.getID()))
+    updateStateStatistics(1);
+
+  theStatisticManager->copyIndexedValues(snapshot->indexedValues);
+  if (UseCallPaths)
+    callPathManager.getSummaryStatistics(snapshot->callSiteStats);
+
+  if (istatsMask & (1ULL<<stats::states.getID()))
+    updateStateStatistics((uint64_t)-1);
+
+  {
+    std::lock_guard<std::mutex> guard(writerLock);
+    pendingIStats = std::move(snapshot);
+  }
+  writerCond.notify_one();
+}
+
+void StatsTracker::formatIStats(const IStatsSnapshot &snapshot) {
   const auto m = executor.kmodule->module.get();
-  uint64_t istatsMask = 0;
   llvm::raw_fd_ostream &of = *istatsFile;
   
   // We assume that we didn't move the file pointer
@@ -620,25 +773,10 @@ void StatsTracker::writeIStats() {
   StatisticManager &sm = *theStatisticManager;
   unsigned nStats = sm.getNumStatistics();
 
-  // Max is 13, sadly
-  istatsMask |= 1<<sm.getStatisticID("Queries");
-  istatsMask |= 1<<sm.getStatisticID("QueriesValid");
-  istatsMask |= 1<<sm.getStatisticID("QueriesInvalid");
-  istatsMask |= 1<<sm.getStatisticID("QueryTime");
-  istatsMask |= 1<<sm.getStatisticID("ResolveTime");
-  istatsMask |= 1<<sm.getStatisticID("Instructions");
-  istatsMask |= 1<<sm.getStatisticID("InstructionTimes");
-  istatsMask |= 1<<sm.getStatisticID("InstructionRealTimes");
-  istatsMask |= 1<<sm.getStatisticID("Forks");
-  istatsMask |= 1<<sm.getStatisticID("CoveredInstructions");
-  istatsMask |= 1<<sm.getStatisticID("UncoveredInstructions");
-  istatsMask |= 1<<sm.getStatisticID("States");
-  istatsMask |= 1<<sm.getStatisticID("MinDistToUncovered");
-
   of << "positions: instr line\n";
 
   for (unsigned i=0; i<nStats; i++) {
-    if (istatsMask & (1<<i)) {
+    if (istatsMask & (1ULL<<i)) {
       Statistic &s = sm.getStatistic(i);
       of << "event: " << s.getShortName() << " : " 
          << s.getName() << "\n";
@@ -647,21 +785,13 @@ void StatsTracker::writeIStats() {
 
   of << "events: ";
   for (unsigned i=0; i<nStats; i++) {
-    if (istatsMask & (1<<i))
+    if (istatsMask & (1ULL<<i))
       of << sm.getStatistic(i).getShortName() << " ";
   }
   of << "\n";
-  
-  // set state counts, decremented after we process so that we don't
-  // have to zero all records each time.
-  if (istatsMask & (1<<stats::states.getID()))
-    updateStateStatistics(1);
 
   std::string sourceFile = "";
-
-  CallSiteSummaryTable callSiteStats;
-  if (UseCallPaths)
-    callPathManager.getSummaryStatistics(callSiteStats);
+  const CallSiteSummaryTable &callSiteStats = snapshot.callSiteStats;
 
   of << "ob=" << objectFilename << "\n";
 
@@ -693,18 +823,18 @@ void StatsTracker::writeIStats() {
           of << ii.assemblyLine << " ";
           of << ii.line << " ";
           for (unsigned i=0; i<nStats; i++)
-            if (istatsMask&(1<<i))
-              of << sm.getIndexedValue(sm.getStatistic(i), index) << " ";
+            if (istatsMask&(1ULL<<i))
+              of << snapshot.indexedValues[index * nStats + i] << " ";
           of << "\n";
 
           if (UseCallPaths && 
               (isa<CallInst>(instr) || isa<InvokeInst>(instr))) {
-            CallSiteSummaryTable::iterator it = callSiteStats.find(instr);
+            auto it = callSiteStats.find(instr);
             if (it!=callSiteStats.end()) {
               for (auto fit = it->second.begin(), fie = it->second.end();
                    fit != fie; ++fit) {
                 const Function *f = fit->first;
-                CallSiteInfo &csi = fit->second;
+                const CallSiteInfo &csi = fit->second;
                 const FunctionInfo &fii =
                     executor.kmodule->infos->getFunctionInfo(*f);
 
@@ -718,7 +848,7 @@ void StatsTracker::writeIStats() {
                 of << ii.assemblyLine << " ";
                 of << ii.line << " ";
                 for (unsigned i=0; i<nStats; i++) {
-                  if (istatsMask&(1<<i)) {
+                  if (istatsMask&(1ULL<<i)) {
                     Statistic &s = sm.getStatistic(i);
                     uint64_t value;
 
@@ -742,9 +872,6 @@ void StatsTracker::writeIStats() {
     }
   }
 
-  if (istatsMask & (1<<stats::states.getID()))
-    updateStateStatistics((uint64_t)-1);
-  
   // Clear then end of the file if necessary (no truncate op?).
   unsigned pos = of.tell();
   for (unsigned i=pos; i<istatsSize; ++i)
@@ -13,9 +13,15 @@
 #include "CallPathManager.h"
 #include "klee/Internal/System/Time.h"
 
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sqlite3.h>
+#include <thread>
+#include <vector>
 
 namespace llvm {
   class BranchInst;
@@ -55,6 +61,29 @@ namespace klee {
 
     bool updateMinDistToUncovered;
 
+    /// The statistics shown in run.istats.
+    uint64_t istatsMask = 0;
+
+    /// A row of run.stats, in column order.
+    typedef std::vector<int64_t> StatsLine;
+
+    /// The indexed statistics and call site summaries at one point in time.
+    struct IStatsSnapshot {
+      std::vector<uint64_t> indexedValues;
+      CallSiteSummaryTable callSiteStats;
+    };
+
+    // The interpreter only takes snapshots of the statistics, the sqlite
+    // inserts and the istats formatting happen on the writer thread. The
+    // writer only reads the module, which does not change during execution.
+    std::thread writer;
+    std::mutex writerLock;
+    std::condition_variable writerCond;
+    std::deque<StatsLine> pendingLines;
+    // a newer istats snapshot replaces one that was not written yet
+    std::unique_ptr<IStatsSnapshot> pendingIStats;
+    bool stopWriter = false;
+
   public:
     static bool useStatistics();
     static bool useIStats();
@@ -62,9 +91,18 @@ namespace klee {
   private:
     void updateStateStatistics(uint64_t addend);
     void writeStatsHeader();
+
+    /// Snapshot the statistics and queue a row for run.stats.
     void writeStatsLine();
+    /// Snapshot the indexed statistics and queue a rewrite of run.istats.
     void writeIStats();
 
+    void runWriter();
+    /// Write out everything that is queued and join the writer thread.
+    void stopWriterThread();
+    void insertStatsLine(const StatsLine &line);
+    void formatIStats(const IStatsSnapshot &snapshot);
+
   public:
     StatsTracker(Executor &_executor, std::string _objectFilename,
                  bool _updateMinDistToUncovered);
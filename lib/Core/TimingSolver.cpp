@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "TimingSolver.h"
+#include "SolverTrace.h"
 
 #include "klee/Config/Version.h"
 #include "klee/ExecutionState.h"
@@ -22,16 +23,34 @@ using namespace llvm;
 
 /***/
 
+TimingSolver::TimingSolver(Solver *_solver, bool _simplifyExprs)
+  : solver(_solver), simplifyExprs(_simplifyExprs) {}
+
+TimingSolver::~TimingSolver() {
+  // Flush the trace while the statistics it refers to are still alive.
+  trace.reset();
+  delete solver;
+}
+
+void TimingSolver::setTrace(std::unique_ptr<SolverTrace> _trace) {
+  trace = std::move(_trace);
+}
+
 bool TimingSolver::evaluate(const ExecutionState& state, ref<Expr> expr,
                             Solver::Validity &result) {
   expr = state.unfold(expr);
   // Fast path, to avoid timer and OS overhead.
   if (ConstantExpr *CE = dyn_cast<ConstantExpr>(expr)) {
     result = CE->isTrue() ? Solver::True : Solver::False;
+    if (trace)
+      trace->recordConstant(state, SolverTrace::Evaluate, result);
     return true;
   }
 
   TimerStatIncrementer timer(stats::solverTime);
+  SolverTrace::Start traceStart;
+  if (trace)
+    traceStart = trace->start();
 
   if (simplifyExprs)
     expr = state.constraints.simplifyExpr(expr);
@@ -42,6 +61,10 @@ bool TimingSolver::evaluate(const ExecutionState& state, ref<Expr> expr,
   bool success = solver->evaluate(Query(state.rewrittenConstraints, expr), result);
   //bool success = solver->evaluate(Query(state.constraints, expr), result);
 
+  if (trace)
+    trace->record(state, SolverTrace::Evaluate, traceStart, expr, success,
+                  result);
+
   state.queryCost += timer.check();
 
   return success;
@@ -53,10 +76,15 @@ bool TimingSolver::mustBeTrue(const ExecutionState& state, ref<Expr> expr,
   // Fast path, to avoid timer and OS overhead.
   if (ConstantExpr *CE = dyn_cast<ConstantExpr>(expr)) {
     result = CE->isTrue() ? true : false;
+    if (trace)
+      trace->recordConstant(state, SolverTrace::MustBeTrue, result);
     return true;
   }
 
   TimerStatIncrementer timer(stats::solverTime);
+  SolverTrace::Start traceStart;
+  if (trace)
+    traceStart = trace->start();
 
   if (simplifyExprs)
     expr = state.constraints.simplifyExpr(expr);
@@ -67,6 +95,10 @@ bool TimingSolver::mustBeTrue(const ExecutionState& state, ref<Expr> expr,
   bool success = solver->mustBeTrue(Query(state.rewrittenConstraints, expr), result);
   //bool success = solver->mustBeTrue(Query(state.constraints, expr), result);
 
+  if (trace)
+    trace->record(state, SolverTrace::MustBeTrue, traceStart, expr, success,
+                  result);
+
   state.queryCost += timer.check();
 
   return success;
@@ -101,10 +133,15 @@ bool TimingSolver::getValue(const ExecutionState& state, ref<Expr> expr,
   // Fast path, to avoid timer and OS overhead.
   if (ConstantExpr *CE = dyn_cast<ConstantExpr>(expr)) {
     result = CE;
+    if (trace)
+      trace->recordConstant(state, SolverTrace::GetValue, 0);
     return true;
   }
   
   TimerStatIncrementer timer(stats::solverTime);
+  SolverTrace::Start traceStart;
+  if (trace)
+    traceStart = trace->start();
 
   if (simplifyExprs)
     expr = state.constraints.simplifyExpr(expr);
@@ -115,6 +152,9 @@ bool TimingSolver::getValue(const ExecutionState& state, ref<Expr> expr,
   bool success = solver->getValue(Query(state.rewrittenConstraints, expr), result);
   //bool success = solver->getValue(Query(state.constraints, expr), result);
 
+  if (trace)
+    trace->record(state, SolverTrace::GetValue, traceStart, expr, success, 0);
+
   state.queryCost += timer.check();
 
   return success;
@@ -130,6 +170,9 @@ TimingSolver::getInitialValues(const ExecutionState& state,
     return true;
 
   TimerStatIncrementer timer(stats::solverTime);
+  SolverTrace::Start traceStart;
+  if (trace)
+    traceStart = trace->start();
 
   //ConstraintManager cm;
   //fillConstraints(state, cm, nullptr);
@@ -138,6 +181,10 @@ TimingSolver::getInitialValues(const ExecutionState& state,
   bool success = solver->getInitialValues(Query(state.rewrittenConstraints,
                                                 ConstantExpr::alloc(0, Expr::Bool)),
                                           objects, result);
+
+  if (trace)
+    trace->record(state, SolverTrace::GetInitialValues, traceStart,
+                  ConstantExpr::alloc(0, Expr::Bool), success, 0);
   
   state.queryCost += timer.check();
   
@@ -14,11 +14,13 @@
 #include "klee/Solver.h"
 #include "klee/Internal/System/Time.h"
 
+#include <memory>
 #include <vector>
 
 namespace klee {
   class ExecutionState;
   class Solver;  
+  class SolverTrace;
 
   /// TimingSolver - A simple class which wraps a solver and handles
   /// tracking the statistics that we care about.
@@ -26,6 +28,8 @@ namespace klee {
   public:
     Solver *solver;
     bool simplifyExprs;
+    /// Optional per-query trace, see SolverTrace.
+    std::unique_ptr<SolverTrace> trace;
 
   public:
     /// TimingSolver - Construct a new timing solver.
@@ -33,11 +37,10 @@ namespace klee {
     /// \param _simplifyExprs - Whether expressions should be
     /// simplified (via the constraint manager interface) prior to
     /// querying.
-    TimingSolver(Solver *_solver, bool _simplifyExprs = true) 
-      : solver(_solver), simplifyExprs(_simplifyExprs) {}
-    ~TimingSolver() {
-      delete solver;
-    }
+    TimingSolver(Solver *_solver, bool _simplifyExprs = true);
+    ~TimingSolver();
+
+    void setTrace(std::unique_ptr<SolverTrace> _trace);
 
     void setTimeout(time::Span t) {
       solver->setCoreSolverTimeout(t);
@@ -1,18 +1,39 @@
 #include "klee/util/ArrayCache.h"
 
+#include <algorithm>
+#include <cassert>
+
 namespace klee {
 
-ArrayCache::~ArrayCache() {
-  // Free Allocated Array objects
-  for (ArrayHashMap::iterator ai = cachedSymbolicArrays.begin(),
-                              e = cachedSymbolicArrays.end();
-       ai != e; ++ai) {
-    delete *ai;
+namespace {
+  /// Never destroyed, arrays can still be freed during static destruction.
+  std::vector<ArrayFreeListener *> &getFreeListeners() {
+    static std::vector<ArrayFreeListener *> *listeners =
+        new std::vector<ArrayFreeListener *>();
+    return *listeners;
   }
-  for (ArrayPtrVec::iterator ai = concreteArrays.begin(),
-                             e = concreteArrays.end();
-       ai != e; ++ai) {
-    delete *ai;
+}
+
+ArrayFreeListener::ArrayFreeListener() {
+  getFreeListeners().push_back(this);
+}
+
+ArrayFreeListener::~ArrayFreeListener() {
+  std::vector<ArrayFreeListener *> &listeners = getFreeListeners();
+  listeners.erase(std::find(listeners.begin(), listeners.end(), this));
+}
+
+ArrayCache::~ArrayCache() {
+  // Free Allocated Array objects. Arrays that are still referenced are
+  // freed when their last reference goes away.
+  std::vector<const Array *> arrays(cachedSymbolicArrays.begin(),
+                                    cachedSymbolicArrays.end());
+  arrays.insert(arrays.end(), concreteArrays.begin(), concreteArrays.end());
+  for (const Array *array : arrays) {
+    array->cache = nullptr;
+    array->released = true;
+    if (!array->refCount)
+      free(array);
   }
 }
 
@@ -22,8 +43,9 @@ ArrayCache::CreateArray(const std::string &_name, uint64_t _size,
                         const ref<ConstantExpr> *constantValuesEnd,
                         Expr::Width _domain, Expr::Width _range) {
 
-  const Array *array = new Array(_name, _size, constantValuesBegin,
-                                 constantValuesEnd, _domain, _range);
+  Array *array = new Array(_name, _size, constantValuesBegin,
+                           constantValuesEnd, _domain, _range);
+  array->cache = this;
   if (array->isSymbolicArray()) {
     std::pair<ArrayHashMap::const_iterator, bool> success =
         cachedSymbolicArrays.insert(array);
@@ -33,15 +55,36 @@ ArrayCache::CreateArray(const std::string &_name, uint64_t _size,
     }
     // Cache hit
     delete array;
-    array = *(success.first);
-    assert(array->isSymbolicArray() &&
+    const Array *cached = *(success.first);
+    assert(cached->isSymbolicArray() &&
            "Cached symbolic array is no longer symbolic");
-    return array;
+    return cached;
   } else {
     // Treat every constant array as distinct so we never cache them
     assert(array->isConstantArray());
-    concreteArrays.push_back(array); // For deletion later
+    concreteArrays.insert(array); // For deletion later
     return array;
   }
 }
+
+void ArrayCache::release(const Array *array) {
+  assert(array->isConstantArray() && "symbolic arrays are shared");
+  assert(array->cache == this && "array is owned by another cache");
+  // an array that was never referenced is freed with the cache
+  array->released = true;
+}
+
+void ArrayCache::drop(const Array *array) {
+  assert(array->refCount > 0);
+  if (--array->refCount == 0 && array->released)
+    free(array);
+}
+
+void ArrayCache::free(const Array *array) {
+  for (ArrayFreeListener *listener : getFreeListeners())
+    listener->arrayFreed(array);
+  if (array->cache)
+    array->cache->concreteArrays.erase(array);
+  delete array;
+}
 }
@@ -64,7 +64,8 @@ ConstantArrayExprVisitor::visitConcat(const ConcatExpr &ce) {
     if (base->updates.root->isConstantArray() &&
         !isa<ConstantExpr>(base->index)) {
       for (const UpdateNode *un = base->updates.head; un; un = un->next) {
-        if (!isa<ConstantExpr>(un->index) || !isa<ConstantExpr>(un->value)) {
+        if (!isa<ConstantExpr>(un->index) || !isa<ConstantExpr>(un->value) ||
+            un->getNumElements(base->updates.root->getRange()) != 1) {
           incompatible = true;
           return Action::skipChildren();
         }
@@ -98,7 +99,8 @@ ExprVisitor::Action ConstantArrayExprVisitor::visitRead(const ReadExpr &re) {
   // that is read at a symbolic index
   if (re.updates.root->isConstantArray() && !isa<ConstantExpr>(re.index)) {
     for (const UpdateNode *un = re.updates.head; un; un = un->next) {
-      if (!isa<ConstantExpr>(un->index) || !isa<ConstantExpr>(un->value)) {
+      if (!isa<ConstantExpr>(un->index) || !isa<ConstantExpr>(un->value) ||
+          un->getNumElements(re.updates.root->getRange()) != 1) {
         incompatible = true;
         return Action::skipChildren();
       }
@@ -205,8 +207,10 @@ ExprVisitor::Action ArrayReadExprVisitor::inspectRead(unsigned hash,
         // Check preconditions on UpdateList nodes
         bool hasConcreteValues = false;
         for (const UpdateNode *un = re.updates.head; un; un = un->next) {
-          // Symbolic case - \inv(update): index is concrete
-          if (!isa<ConstantExpr>(un->index)) {
+          // Symbolic case - \inv(update): index is concrete, and a single
+          // element is written
+          if (!isa<ConstantExpr>(un->index) ||
+              un->getNumElements(re.updates.root->getRange()) != 1) {
             incompatible = true;
             break;
           } else if (!isa<ConstantExpr>(un->value)) {
@@ -10,6 +10,7 @@
 #include "klee/Expr.h"
 
 #include "klee/Config/Version.h"
+#include "klee/Internal/ADT/NodePool.h"
 // FIXME: We shouldn't need this once fast constant support moves into
 // Core. If we need to do arithmetic, we probably want to use APInt.
 #include "klee/Internal/Support/IntEvaluation.h"
@@ -43,6 +44,20 @@ cl::opt<bool> ConstArrayOpt(
 
 unsigned Expr::count = 0;
 
+static SizeClassPool &getExprPool() {
+  // Never destroyed, expressions may be released during static destruction.
+  static SizeClassPool *pool = new SizeClassPool();
+  return *pool;
+}
+
+void *Expr::operator new(size_t size) {
+  return getExprPool().allocate(size);
+}
+
+void Expr::operator delete(void *p, size_t size) {
+  getExprPool().deallocate(p, size);
+}
+
 ref<Expr> Expr::createTempRead(const Array *array, Expr::Width w) {
   UpdateList ul(array, 0);
 
@@ -504,7 +519,8 @@ Array::Array(const std::string &_name, uint64_t _size,
              const ref<ConstantExpr> *constantValuesEnd, Expr::Width _domain,
              Expr::Width _range)
     : name(_name), size(_size), domain(_domain), range(_range),
-      constantValues(constantValuesBegin, constantValuesEnd) {
+      constantValues(constantValuesBegin, constantValuesEnd), refCount(0),
+      released(false), cache(nullptr) {
 
   assert((isSymbolicArray() || constantValues.size() == size) &&
          "Invalid size for constant array!");
@@ -545,6 +561,22 @@ ref<Expr> ReadExpr::create(const UpdateList &ul, ref<Expr> index) {
   const UpdateNode *un = ul.head;
   bool updateListHasSymbolicWrites = false;
   for (; un; un=un->next) {
+    unsigned elements = un->getNumElements(ul.root->getRange());
+    if (elements != 1) {
+      // The update writes index iff index - un->index is below the number
+      // of elements it writes (modulo the domain)
+      ref<Expr> k = SubExpr::create(index, un->index);
+      if (ConstantExpr *CE = dyn_cast<ConstantExpr>(k)) {
+        if (CE->getZExtValue() < elements)
+          return un->getElementValue(CE->getZExtValue(),
+                                     ul.root->getRange());
+      } else {
+        updateListHasSymbolicWrites = true;
+        break;
+      }
+      continue;
+    }
+
     // Check if we have an equivalent concrete index
     ref<Expr> cond = EqExpr::create(index, un->index);
     if (ConstantExpr *CE = dyn_cast<ConstantExpr>(cond)) {
@@ -325,9 +325,10 @@ namespace {
 
     virtual ref<Expr> Read(const UpdateList &Updates,
                            const ref<Expr> &Index) {
-      // Roll back through writes when possible.
+      // Roll back through single element writes when possible.
       const UpdateNode *UN = Updates.head;
-      while (UN && Eq(Index, UN->index)->isFalse())
+      while (UN && UN->getNumElements(Updates.root->getRange()) == 1 &&
+             Eq(Index, UN->index)->isFalse())
         UN = UN->next;
 
       if (ConstantExpr *CE = dyn_cast<ConstantExpr>(Index))
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "klee/util/ExprEvaluator.h"
+#include "klee/util/Bits.h"
 
 using namespace klee;
 
@@ -17,8 +18,12 @@ ExprVisitor::Action ExprEvaluator::evalRead(const UpdateList &ul,
     ref<Expr> ui = visit(un->index);
     
     if (ConstantExpr *CE = dyn_cast<ConstantExpr>(ui)) {
-      if (CE->getZExtValue() == index)
-        return Action::changeTo(visit(un->value));
+      // an update may write several consecutive elements
+      uint64_t k = bits64::truncateToNBits(index - CE->getZExtValue(),
+                                           ul.root->getDomain());
+      if (k < un->getNumElements(ul.root->getRange()))
+        return Action::changeTo(
+            visit(un->getElementValue(k, ul.root->getRange())));
     } else {
       // update index is unknown, so may or may not be index, we
       // cannot guarantee value. we can rewrite to read at this
@@ -185,7 +185,9 @@ private:
       print(un->index, PC);
       //printSeparator(PC, isSimple(un->index), innerIndent);
       PC << "=";
-      print(un->value, PC);
+      // the width tells an update of several elements apart
+      print(un->value, PC,
+            un->value->getWidth() != updates.root->getRange());
       //PC << ')';
       
       nextShouldBreak = !(isa<ConstantExpr>(un->index) && 
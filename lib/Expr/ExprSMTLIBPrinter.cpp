@@ -478,25 +478,31 @@ const char *ExprSMTLIBPrinter::getSMTLIBKeyword(const ref<Expr> &e) {
 void ExprSMTLIBPrinter::printUpdatesAndArray(const UpdateNode *un,
                                              const Array *root) {
   if (un != NULL) {
-    *p << "(store ";
-    p->pushIndent();
-    printSeperator();
+    // an update of several elements is printed as one store per element
+    unsigned elements = un->getNumElements(root->getRange());
+    for (unsigned k = 0; k != elements; ++k) {
+      *p << "(store ";
+      p->pushIndent();
+      printSeperator();
+    }
 
     // recurse to get the array or update that this store operations applies to
     printUpdatesAndArray(un->next, root);
 
-    printSeperator();
+    for (unsigned k = 0; k != elements; ++k) {
+      printSeperator();
 
-    // print index
-    printExpression(un->index, SORT_BITVECTOR);
-    printSeperator();
+      // print index
+      printExpression(un->getElementIndex(k), SORT_BITVECTOR);
+      printSeperator();
 
-    // print value that is assigned to this index of the array
-    printExpression(un->value, SORT_BITVECTOR);
+      // print value that is assigned to this index of the array
+      printExpression(un->getElementValue(k, root->getRange()), SORT_BITVECTOR);
 
-    p->popIndent();
-    printSeperator();
-    *p << ")";
+      p->popIndent();
+      printSeperator();
+      *p << ")";
+    }
   } else {
     // The base case of the recursion
     *p << root->name;
@@ -1412,7 +1412,8 @@ VersionResult ParserImpl::ParseVersion() {
       RHS = ParseNumberToken(ArrayRangeType, WI.RHS.getNumber());
     } else {
       RHS = WI.RHS.getExpr();
-      if (RHS.isValid() && RHS.get()->getWidth() != ArrayRangeType) {
+      // An update may write several consecutive elements.
+      if (RHS.isValid() && RHS.get()->getWidth() % ArrayRangeType != 0) {
         Error("invalid write value (doesn't match array range).", WI.RHSTok);
         RHS = ExprResult();
       }
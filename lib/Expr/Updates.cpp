@@ -8,13 +8,31 @@
 //===----------------------------------------------------------------------===//
 
 #include "klee/Expr.h"
+#include "klee/Internal/ADT/NodePool.h"
+#include "klee/util/ArrayCache.h"
 
 #include <cassert>
+#include <vector>
 
 using namespace klee;
 
 ///
 
+static FixedSizePool &getUpdateNodePool() {
+  // Never destroyed, update lists may be released during static destruction.
+  static FixedSizePool *pool = new FixedSizePool(sizeof(UpdateNode));
+  return *pool;
+}
+
+void *UpdateNode::operator new(size_t size) {
+  assert(size == sizeof(UpdateNode));
+  return getUpdateNodePool().allocate();
+}
+
+void UpdateNode::operator delete(void *p, size_t size) {
+  getUpdateNodePool().deallocate(p);
+}
+
 UpdateNode::UpdateNode(const UpdateNode *_next, 
                        const ref<Expr> &_index, 
                        const ref<Expr> &_value) 
@@ -46,6 +64,16 @@ UpdateNode::~UpdateNode() {
     assert(refCount == 0 && "Deleted UpdateNode when a reference is still held");
 }
 
+ref<Expr> UpdateNode::getElementIndex(unsigned k) const {
+  if (k == 0)
+    return index;
+  return AddExpr::create(ConstantExpr::create(k, index->getWidth()), index);
+}
+
+ref<Expr> UpdateNode::getElementValue(unsigned k, Expr::Width range) const {
+  return ExtractExpr::create(value, k * range, range);
+}
+
 int UpdateNode::compare(const UpdateNode &b) const {
   if (int i = index.compare(b.index)) 
     return i;
@@ -64,17 +92,20 @@ unsigned UpdateNode::computeHash() {
 UpdateList::UpdateList(const Array *_root, const UpdateNode *_head)
   : root(_root),
     head(_head) {
+  if (root) ArrayCache::retain(root);
   if (head) ++head->refCount;
 }
 
 UpdateList::UpdateList(const UpdateList &b)
   : root(b.root),
     head(b.head) {
+  if (root) ArrayCache::retain(root);
   if (head) ++head->refCount;
 }
 
 UpdateList::~UpdateList() {
     tryFreeNodes();
+    if (root) ArrayCache::drop(root);
 }
 
 void UpdateList::tryFreeNodes() {
@@ -127,18 +158,40 @@ void UpdateList::tryFreeNodes() {
   //  nullptr
   //  ^Head0
   //
+  //
+  // Deleting a node drops its index and value, which may in turn release
+  // other update lists (through ReadExprs). To keep the stack depth bounded,
+  // such nested releases only queue their nodes, and the outermost call
+  // deletes all the queued nodes iteratively.
+  static std::vector<const UpdateNode *> &pending =
+      *new std::vector<const UpdateNode *>();
+  static bool freeing = false;
+
   while (head && --head->refCount==0) {
     const UpdateNode *n = head->next;
-    delete head;
+    pending.push_back(head);
     head = n;
   }
+
+  if (freeing)
+    return;
+
+  freeing = true;
+  while (!pending.empty()) {
+    const UpdateNode *un = pending.back();
+    pending.pop_back();
+    delete un;
+  }
+  freeing = false;
 }
 
 UpdateList &UpdateList::operator=(const UpdateList &b) {
+  if (b.root) ArrayCache::retain(b.root);
   if (b.head) ++b.head->refCount;
   // Drop reference to the current head and free a chain of nodes
   // if we are the only UpdateList referencing them
   tryFreeNodes();
+  if (root) ArrayCache::drop(root);
   root = b.root;
   head = b.head;
   return *this;
@@ -148,7 +201,8 @@ void UpdateList::extend(const ref<Expr> &index, const ref<Expr> &value) {
   
   if (root) {
     assert(root->getDomain() == index->getWidth());
-    assert(root->getRange() == value->getWidth());
+    assert(value->getWidth() % root->getRange() == 0 &&
+           "update value is not a whole number of elements");
   }
 
   if (head) --head->refCount;
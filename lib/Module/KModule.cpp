@@ -417,6 +417,110 @@ static int getOperandNum(Value *v,
   }
 }
 
+/// Resolve the first count operands of ki into its slots, see KOperand.
+static void resolveOperands(KInstruction *ki, unsigned count) {
+  for (unsigned i = 0; i < count; i++) {
+    KOperand &slot = ki->slots[i];
+    int vnumber = ki->operands[i];
+    ConstantInt *ci = dyn_cast<ConstantInt>(ki->inst->getOperand(i));
+    if (vnumber >= 0) {
+      slot.kind = KOperand::Register;
+      slot.value = vnumber;
+    } else if (ci && ci->getBitWidth() <= 64) {
+      slot.kind = KOperand::Inline;
+      slot.width = ci->getBitWidth();
+      slot.value = ci->getZExtValue();
+    } else {
+      slot.kind = KOperand::Constant;
+      slot.value = -vnumber - 2;
+    }
+  }
+}
+
+/// Assign the compact opcode of ki, see KOpcode. Anything that is not
+/// handled here stays Generic.
+static void decodeInstruction(KInstruction *ki, KFunction *kf, KModule *km) {
+  Instruction *inst = ki->inst;
+
+  switch (inst->getOpcode()) {
+  case Instruction::Add: ki->opcode = KOpcode::Add; break;
+  case Instruction::Sub: ki->opcode = KOpcode::Sub; break;
+  case Instruction::Mul: ki->opcode = KOpcode::Mul; break;
+  case Instruction::And: ki->opcode = KOpcode::And; break;
+  case Instruction::Or: ki->opcode = KOpcode::Or; break;
+  case Instruction::Xor: ki->opcode = KOpcode::Xor; break;
+  case Instruction::Shl: ki->opcode = KOpcode::Shl; break;
+  case Instruction::LShr: ki->opcode = KOpcode::LShr; break;
+  case Instruction::AShr: ki->opcode = KOpcode::AShr; break;
+
+  case Instruction::ICmp: {
+    if (inst->getOperand(0)->getType()->isVectorTy())
+      return;
+    switch (cast<ICmpInst>(inst)->getPredicate()) {
+    case ICmpInst::ICMP_EQ: ki->opcode = KOpcode::Eq; break;
+    case ICmpInst::ICMP_NE: ki->opcode = KOpcode::Ne; break;
+    case ICmpInst::ICMP_UGT: ki->opcode = KOpcode::Ugt; break;
+    case ICmpInst::ICMP_UGE: ki->opcode = KOpcode::Uge; break;
+    case ICmpInst::ICMP_ULT: ki->opcode = KOpcode::Ult; break;
+    case ICmpInst::ICMP_ULE: ki->opcode = KOpcode::Ule; break;
+    case ICmpInst::ICMP_SGT: ki->opcode = KOpcode::Sgt; break;
+    case ICmpInst::ICMP_SGE: ki->opcode = KOpcode::Sge; break;
+    case ICmpInst::ICMP_SLT: ki->opcode = KOpcode::Slt; break;
+    case ICmpInst::ICMP_SLE: ki->opcode = KOpcode::Sle; break;
+    default: break; // reported by the generic path
+    }
+    resolveOperands(ki, 2);
+    return;
+  }
+
+  case Instruction::Trunc:
+  case Instruction::ZExt:
+  case Instruction::SExt:
+    if (!inst->getType()->isIntegerTy())
+      return;
+    ki->width = km->targetData->getTypeSizeInBits(inst->getType());
+    if (inst->getOpcode() == Instruction::Trunc)
+      ki->opcode = KOpcode::Trunc;
+    else if (inst->getOpcode() == Instruction::ZExt)
+      ki->opcode = KOpcode::ZExt;
+    else
+      ki->opcode = KOpcode::SExt;
+    resolveOperands(ki, 1);
+    return;
+
+  case Instruction::BitCast:
+    ki->opcode = KOpcode::BitCast;
+    resolveOperands(ki, 1);
+    return;
+
+  case Instruction::Br: {
+    BranchInst *bi = cast<BranchInst>(inst);
+    if (!bi->isUnconditional())
+      return;
+    BasicBlock *dst = bi->getSuccessor(0);
+    ki->opcode = KOpcode::Br;
+    ki->successor = kf->basicBlockEntry[dst];
+    if (PHINode *first = dyn_cast<PHINode>(&*dst->begin()))
+      ki->successorIncoming = first->getBasicBlockIndex(bi->getParent());
+    return;
+  }
+
+  case Instruction::PHI:
+    ki->opcode = KOpcode::PHI;
+    return;
+
+  default:
+    return;
+  }
+
+  // the arithmetic handlers do not know about vectors
+  if (!inst->getType()->isIntegerTy()) {
+    ki->opcode = KOpcode::Generic;
+    return;
+  }
+  resolveOperands(ki, 2);
+}
+
 KFunction::KFunction(llvm::Function *_function,
                      KModule *km) 
   : function(_function),
@@ -482,6 +586,7 @@ KFunction::KFunction(llvm::Function *_function,
         }
       }
 
+      decodeInstruction(ki, this, km);
       instructions[i++] = ki;
     }
   }
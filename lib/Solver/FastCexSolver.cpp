@@ -16,6 +16,7 @@
 #include "klee/util/ExprEvaluator.h"
 #include "klee/util/ExprRangeEvaluator.h"
 #include "klee/util/ExprVisitor.h"
+#include "klee/util/ValueRange.h"
 // FIXME: Use APInt.
 #include "klee/Internal/Support/Debug.h"
 #include "klee/Internal/Support/IntEvaluation.h"
@@ -30,267 +31,6 @@ using namespace klee;
 
 /***/
 
-      // Hacker's Delight, pgs 58-63
-static uint64_t minOR(uint64_t a, uint64_t b,
-                      uint64_t c, uint64_t d) {
-  uint64_t temp, m = ((uint64_t) 1)<<63;
-  while (m) {
-    if (~a & c & m) {
-      temp = (a | m) & -m;
-      if (temp <= b) { a = temp; break; }
-    } else if (a & ~c & m) {
-      temp = (c | m) & -m;
-      if (temp <= d) { c = temp; break; }
-    }
-    m >>= 1;
-  }
-  
-  return a | c;
-}
-static uint64_t maxOR(uint64_t a, uint64_t b,
-                      uint64_t c, uint64_t d) {
-  uint64_t temp, m = ((uint64_t) 1)<<63;
-
-  while (m) {
-    if (b & d & m) {
-      temp = (b - m) | (m - 1);
-      if (temp >= a) { b = temp; break; }
-      temp = (d - m) | (m -1);
-      if (temp >= c) { d = temp; break; }
-    }
-    m >>= 1;
-  }
-
-  return b | d;
-}
-static uint64_t minAND(uint64_t a, uint64_t b,
-                       uint64_t c, uint64_t d) {
-  uint64_t temp, m = ((uint64_t) 1)<<63;
-  while (m) {
-    if (~a & ~c & m) {
-      temp = (a | m) & -m;
-      if (temp <= b) { a = temp; break; }
-      temp = (c | m) & -m;
-      if (temp <= d) { c = temp; break; }
-    }
-    m >>= 1;
-  }
-  
-  return a & c;
-}
-static uint64_t maxAND(uint64_t a, uint64_t b,
-                       uint64_t c, uint64_t d) {
-  uint64_t temp, m = ((uint64_t) 1)<<63;
-  while (m) {
-    if (b & ~d & m) {
-      temp = (b & ~m) | (m - 1);
-      if (temp >= a) { b = temp; break; }
-    } else if (~b & d & m) {
-      temp = (d & ~m) | (m - 1);
-      if (temp >= c) { d = temp; break; }
-    }
-    m >>= 1;
-  }
-  
-  return b & d;
-}
-
-///
-
-class ValueRange {
-private:
-  uint64_t m_min, m_max;
-
-public:
-  ValueRange() : m_min(1),m_max(0) {}
-  ValueRange(const ref<ConstantExpr> &ce) {
-    // FIXME: Support large widths.
-    m_min = m_max = ce->getLimitedValue();
-  }
-  ValueRange(uint64_t value) : m_min(value), m_max(value) {}
-  ValueRange(uint64_t _min, uint64_t _max) : m_min(_min), m_max(_max) {}
-  ValueRange(const ValueRange &b) : m_min(b.m_min), m_max(b.m_max) {}
-
-  void print(llvm::raw_ostream &os) const {
-    if (isFixed()) {
-      os << m_min;
-    } else {
-      os << "[" << m_min << "," << m_max << "]";
-    }
-  }
-
-  bool isEmpty() const { 
-    return m_min>m_max; 
-  }
-  bool contains(uint64_t value) const { 
-    return this->intersects(ValueRange(value)); 
-  }
-  bool intersects(const ValueRange &b) const { 
-    return !this->set_intersection(b).isEmpty(); 
-  }
-
-  bool isFullRange(unsigned bits) {
-    return m_min==0 && m_max==bits64::maxValueOfNBits(bits);
-  }
-
-  ValueRange set_intersection(const ValueRange &b) const {
-    return ValueRange(std::max(m_min,b.m_min), std::min(m_max,b.m_max));
-  }
-  ValueRange set_union(const ValueRange &b) const {
-    return ValueRange(std::min(m_min,b.m_min), std::max(m_max,b.m_max));
-  }
-  ValueRange set_difference(const ValueRange &b) const {
-    if (b.isEmpty() || b.m_min > m_max || b.m_max < m_min) { // no intersection
-      return *this;
-    } else if (b.m_min <= m_min && b.m_max >= m_max) { // empty
-      return ValueRange(1,0); 
-    } else if (b.m_min <= m_min) { // one range out
-      // cannot overflow because b.m_max < m_max
-      return ValueRange(b.m_max+1, m_max);
-    } else if (b.m_max >= m_max) {
-      // cannot overflow because b.min > m_min
-      return ValueRange(m_min, b.m_min-1);
-    } else {
-      // two ranges, take bottom
-      return ValueRange(m_min, b.m_min-1);
-    }
-  }
-  ValueRange binaryAnd(const ValueRange &b) const {
-    // XXX
-    assert(!isEmpty() && !b.isEmpty() && "XXX");
-    if (isFixed() && b.isFixed()) {
-      return ValueRange(m_min & b.m_min);
-    } else {
-      return ValueRange(minAND(m_min, m_max, b.m_min, b.m_max),
-                        maxAND(m_min, m_max, b.m_min, b.m_max));
-    }
-  }
-  ValueRange binaryAnd(uint64_t b) const { return binaryAnd(ValueRange(b)); }
-  ValueRange binaryOr(ValueRange b) const {
-    // XXX
-    assert(!isEmpty() && !b.isEmpty() && "XXX");
-    if (isFixed() && b.isFixed()) {
-      return ValueRange(m_min | b.m_min);
-    } else {
-      return ValueRange(minOR(m_min, m_max, b.m_min, b.m_max),
-                        maxOR(m_min, m_max, b.m_min, b.m_max));
-    }
-  }
-  ValueRange binaryOr(uint64_t b) const { return binaryOr(ValueRange(b)); }
-  ValueRange binaryXor(ValueRange b) const {
-    if (isFixed() && b.isFixed()) {
-      return ValueRange(m_min ^ b.m_min);
-    } else {
-      uint64_t t = m_max | b.m_max;
-      while (!bits64::isPowerOfTwo(t))
-        t = bits64::withoutRightmostBit(t);
-      return ValueRange(0, (t<<1)-1);
-    }
-  }
-
-  ValueRange binaryShiftLeft(unsigned bits) const {
-    return ValueRange(m_min<<bits, m_max<<bits);
-  }
-  ValueRange binaryShiftRight(unsigned bits) const {
-    return ValueRange(m_min>>bits, m_max>>bits);
-  }
-
-  ValueRange concat(const ValueRange &b, unsigned bits) const {
-    return binaryShiftLeft(bits).binaryOr(b);
-  }
-  ValueRange extract(uint64_t lowBit, uint64_t maxBit) const {
-    return binaryShiftRight(lowBit).binaryAnd(bits64::maxValueOfNBits(maxBit-lowBit));
-  }
-
-  ValueRange add(const ValueRange &b, unsigned width) const {
-    return ValueRange(0, bits64::maxValueOfNBits(width));
-  }
-  ValueRange sub(const ValueRange &b, unsigned width) const {
-    return ValueRange(0, bits64::maxValueOfNBits(width));
-  }
-  ValueRange mul(const ValueRange &b, unsigned width) const {
-    return ValueRange(0, bits64::maxValueOfNBits(width));
-  }
-  ValueRange udiv(const ValueRange &b, unsigned width) const {
-    return ValueRange(0, bits64::maxValueOfNBits(width));
-  }
-  ValueRange sdiv(const ValueRange &b, unsigned width) const {
-    return ValueRange(0, bits64::maxValueOfNBits(width));
-  }
-  ValueRange urem(const ValueRange &b, unsigned width) const {
-    return ValueRange(0, bits64::maxValueOfNBits(width));
-  }
-  ValueRange srem(const ValueRange &b, unsigned width) const {
-    return ValueRange(0, bits64::maxValueOfNBits(width));
-  }
-
-  // use min() to get value if true (XXX should we add a method to
-  // make code clearer?)
-  bool isFixed() const { return m_min==m_max; }
-
-  bool operator==(const ValueRange &b) const { 
-    return m_min==b.m_min && m_max==b.m_max; 
-  }
-  bool operator!=(const ValueRange &b) const { return !(*this==b); }
-
-  bool mustEqual(const uint64_t b) const { return m_min==m_max && m_min==b; }
-  bool mayEqual(const uint64_t b) const { return m_min<=b && m_max>=b; }
-  
-  bool mustEqual(const ValueRange &b) const { 
-    return isFixed() && b.isFixed() && m_min==b.m_min; 
-  }
-  bool mayEqual(const ValueRange &b) const { return this->intersects(b); }
-
-  uint64_t min() const { 
-    assert(!isEmpty() && "cannot get minimum of empty range");
-    return m_min; 
-  }
-
-  uint64_t max() const { 
-    assert(!isEmpty() && "cannot get maximum of empty range");
-    return m_max; 
-  }
-  
-  int64_t minSigned(unsigned bits) const {
-    assert((m_min>>bits)==0 && (m_max>>bits)==0 &&
-           "range is outside given number of bits");
-
-    // if max allows sign bit to be set then it can be smallest value,
-    // otherwise since the range is not empty, min cannot have a sign
-    // bit
-
-    uint64_t smallest = ((uint64_t) 1 << (bits-1));
-    if (m_max >= smallest) {
-      return ints::sext(smallest, 64, bits);
-    } else {
-      return m_min;
-    }
-  }
-
-  int64_t maxSigned(unsigned bits) const {
-    assert((m_min>>bits)==0 && (m_max>>bits)==0 &&
-           "range is outside given number of bits");
-
-    uint64_t smallest = ((uint64_t) 1 << (bits-1));
-
-    // if max and min have sign bit then max is max, otherwise if only
-    // max has sign bit then max is largest signed integer, otherwise
-    // max is max
-
-    if (m_min < smallest && m_max >= smallest) {
-      return smallest - 1;
-    } else {
-      return ints::sext(m_max, 64, bits);
-    }
-  }
-};
-
-inline llvm::raw_ostream &operator<<(llvm::raw_ostream &os,
-                                     const ValueRange &vr) {
-  vr.print(os);
-  return os;
-}
-
 // XXX waste of space, rather have ByteValueRange
 typedef ValueRange CexValueData;
 
@@ -798,16 +538,23 @@ public:
       CexValueData index = evalRangeForExpr(re->index);
         
       for (const UpdateNode *un = re->updates.head; un; un = un->next) {
-        CexValueData ui = evalRangeForExpr(un->index);
-
-        // If these indices can't alias, continue propogation
-        if (!ui.mayEqual(index))
-          continue;
-
-        // Otherwise if we know they alias, propogate into the write value.
-        if (ui.mustEqual(index) || re->index == un->index)
-          propogateExactValues(un->value, range);
-        return;
+        // An update may write several consecutive elements, each of which
+        // is checked like a single write.
+        unsigned elements = un->getNumElements(array->getRange());
+        for (unsigned k = 0; k != elements; ++k) {
+          ref<Expr> elementIndex = un->getElementIndex(k);
+          CexValueData ui = evalRangeForExpr(elementIndex);
+
+          // If these indices can't alias, continue propogation
+          if (!ui.mayEqual(index))
+            continue;
+
+          // Otherwise if we know they alias, propogate into the write value.
+          if (ui.mustEqual(index) || re->index == elementIndex)
+            propogateExactValues(un->getElementValue(k, array->getRange()),
+                                 range);
+          return;
+        }
       }
 
       // We reached the initial array write, update the exact range if possible.
@@ -186,10 +186,27 @@ MetaSMTBuilder<SolverContext>::getArrayForUpdate(const Array *root,
     bool hashed = _arr_hash.lookupUpdateNodeExpr(un, un_expr);
 
     if (!hashed) {
-      un_expr = evaluate(_solver,
-                         metaSMT::logic::Array::store(
-                             getArrayForUpdate(root, un->next),
-                             construct(un->index, 0), construct(un->value, 0)));
+      un_expr = getArrayForUpdate(root, un->next);
+      typename SolverContext::result_type index = construct(un->index, 0);
+      typename SolverContext::result_type value = construct(un->value, 0);
+      unsigned elements = un->getNumElements(root->getRange());
+      if (elements == 1) {
+        un_expr = evaluate(_solver,
+                           metaSMT::logic::Array::store(un_expr, index, value));
+      } else {
+        // Store each element at its own index, sharing the index and the
+        // value with all of them.
+        for (unsigned k = 0; k != elements; ++k) {
+          unsigned bit = k * root->getRange();
+          un_expr = evaluate(
+              _solver,
+              metaSMT::logic::Array::store(
+                  un_expr,
+                  evaluate(_solver,
+                           bvadd(index, bvConst32(root->getDomain(), k))),
+                  bvExtract(value, bit + root->getRange() - 1, bit)));
+        }
+      }
       _arr_hash.hashUpdateNodeExpr(un, un_expr);
     }
     return (un_expr);
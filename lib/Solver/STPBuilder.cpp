@@ -76,6 +76,15 @@ STPArrayExprHash::~STPArrayExprHash() {
   }
 }
 
+void STPArrayExprHash::arrayFreed(const Array *array) {
+  ArrayHashIter it = _array_hash.find(array);
+  if (it == _array_hash.end())
+    return;
+  if (it->second)
+    ::vc_DeleteExpr(it->second);
+  _array_hash.erase(it);
+}
+
 /***/
 
 STPBuilder::STPBuilder(::VC _vc, bool _optimizeDivides)
@@ -438,8 +447,8 @@ ExprHandle STPBuilder::constructSDivByConstant(ExprHandle expr_n, unsigned width
   
   if (!hashed) {
     // STP uniques arrays by name, so we make sure the name is unique by
-    // using the size of the array hash as a counter.
-    std::string unique_id = llvm::itostr(_arr_hash._array_hash.size());
+    // using the number of hashed arrays as a counter.
+    std::string unique_id = llvm::itostr(_arr_hash._hashed_arrays);
     unsigned const uid_length = unique_id.length();
     unsigned const space = (root->name.length() > 32 - uid_length)
                                ? (32 - uid_length)
@@ -483,10 +492,24 @@ ExprHandle STPBuilder::getInitialRead(const Array *root, unsigned index) {
       bool hashed = _arr_hash.lookupUpdateNodeExpr(un, un_expr);
       
       if (!hashed) {
-	un_expr = vc_writeExpr(vc,
-                               getArrayForUpdate(root, un->next),
-                               construct(un->index, 0),
-                               construct(un->value, 0));
+	un_expr = getArrayForUpdate(root, un->next);
+	ExprHandle index = construct(un->index, 0);
+	ExprHandle value = construct(un->value, 0);
+	unsigned elements = un->getNumElements(root->getRange());
+	if (elements == 1) {
+	  un_expr = vc_writeExpr(vc, un_expr, index, value);
+	} else {
+	  // Store each element at its own index, sharing the index and the
+	  // value with all of them.
+	  for (unsigned k = 0; k != elements; ++k) {
+	    unsigned bit = k * root->getRange();
+	    un_expr = vc_writeExpr(
+	        vc, un_expr,
+	        vc_bvPlusExpr(vc, root->getDomain(), index,
+	                      bvConst32(root->getDomain(), k)),
+	        bvExtract(value, bit + root->getRange() - 1, bit));
+	  }
+	}
 	
 	if (UseNodeCache) {
 	  _arr_hash.hashUpdateNodeExpr(un, un_expr);
@@ -60,6 +60,7 @@ namespace klee {
   public:
     STPArrayExprHash() {};
     virtual ~STPArrayExprHash();
+    virtual void arrayFreed(const Array *array);
   };
 
 class STPBuilder {
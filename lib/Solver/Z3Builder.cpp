@@ -391,8 +391,8 @@ Z3ASTHandle Z3Builder::getInitialArray(const Array *root) {
 
   if (!hashed) {
     // Unique arrays by name, so we make sure the name is unique by
-    // using the size of the array hash as a counter.
-    std::string unique_id = llvm::itostr(_arr_hash._array_hash.size());
+    // using the number of hashed arrays as a counter.
+    std::string unique_id = llvm::itostr(_arr_hash._hashed_arrays);
     unsigned const uid_length = unique_id.length();
     unsigned const space = (root->name.length() > 32 - uid_length)
                                ? (32 - uid_length)
@@ -439,8 +439,24 @@ Z3ASTHandle Z3Builder::getArrayForUpdate(const Array *root,
     bool hashed = _arr_hash.lookupUpdateNodeExpr(un, un_expr);
 
     if (!hashed) {
-      un_expr = writeExpr(getArrayForUpdate(root, un->next),
-                          construct(un->index, 0), construct(un->value, 0));
+      un_expr = getArrayForUpdate(root, un->next);
+      Z3ASTHandle index = construct(un->index, 0);
+      Z3ASTHandle value = construct(un->value, 0);
+      unsigned elements = un->getNumElements(root->getRange());
+      if (elements == 1) {
+        un_expr = writeExpr(un_expr, index, value);
+      } else {
+        // Store each element at its own index, sharing the index and the
+        // value with all of them.
+        for (unsigned k = 0; k != elements; ++k) {
+          unsigned bit = k * root->getRange();
+          Z3ASTHandle elementIndex = Z3ASTHandle(
+              Z3_mk_bvadd(ctx, index, bvConst32(root->getDomain(), k)), ctx);
+          un_expr = writeExpr(
+              un_expr, elementIndex,
+              bvExtract(value, bit + root->getRange() - 1, bit));
+        }
+      }
 
       _arr_hash.hashUpdateNodeExpr(un, un_expr);
     }
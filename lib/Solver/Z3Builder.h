@@ -100,7 +100,7 @@ public:
   void clear();
 };
 
-class Z3Builder {
+class Z3Builder : public ArrayFreeListener {
   ExprHashMap<std::pair<Z3ASTHandle, unsigned> > constructed;
   Z3ArrayExprHash _arr_hash;
 
@@ -175,6 +175,10 @@ public:
   Z3Builder(bool autoClearConstructCache, const char *z3LogInteractionFile);
   ~Z3Builder();
 
+  void arrayFreed(const Array *array) override {
+    constant_array_assertions.erase(array);
+  }
+
   Z3ASTHandle getTrue();
   Z3ASTHandle getFalse();
   Z3ASTHandle getInitialRead(const Array *os, unsigned index);
@@ -0,0 +1,123 @@
+//===-- DirtyPages.cpp ----------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Internal/System/DirtyPages.h"
+
+#include "klee/Internal/Support/ErrorHandling.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace klee;
+using namespace klee::util;
+
+#ifdef __linux__
+
+/* bit 55 of a pagemap entry */
+static const uint64_t SoftDirtyBit = 1ULL << 55;
+
+DirtyPageTracker::DirtyPageTracker() : pagemap(-1) {
+  pageSize = sysconf(_SC_PAGESIZE);
+  pagemap = open("/proc/self/pagemap", O_RDONLY);
+  if (pagemap < 0)
+    return;
+
+  /* check that the kernel tracks writes (CONFIG_MEM_SOFT_DIRTY) */
+  void *probe = mmap(nullptr, pageSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  bool dirty = false;
+  bool success = probe != MAP_FAILED && clear();
+  if (success) {
+    *static_cast<volatile char *>(probe) = 1;
+    success = isDirty((uint64_t)probe / pageSize, dirty);
+  }
+  if (probe != MAP_FAILED)
+    munmap(probe, pageSize);
+
+  if (!success || !dirty) {
+    klee_warning("soft-dirty page tracking is not available");
+    close(pagemap);
+    pagemap = -1;
+  }
+}
+
+DirtyPageTracker::~DirtyPageTracker() {
+  if (pagemap >= 0)
+    close(pagemap);
+}
+
+bool DirtyPageTracker::clear() {
+  int fd = open("/proc/self/clear_refs", O_WRONLY);
+  if (fd < 0)
+    return false;
+  bool success = write(fd, "4", 1) == 1;
+  close(fd);
+  return success;
+}
+
+bool DirtyPageTracker::isDirty(uint64_t page, bool &dirty) {
+  uint64_t entry;
+  if (pread(pagemap, &entry, sizeof(entry), page * sizeof(entry)) !=
+      sizeof(entry))
+    return false;
+  dirty = (entry & SoftDirtyBit) != 0;
+  return true;
+}
+
+void DirtyPageTracker::reset() {
+  if (pagemap >= 0 && !clear()) {
+    klee_warning("failed to clear soft-dirty bits, disabling page tracking");
+    close(pagemap);
+    pagemap = -1;
+  }
+}
+
+bool DirtyPageTracker::mayBeDirty(uint64_t address, size_t size) {
+  if (pagemap < 0 || size == 0)
+    return true;
+
+  uint64_t first = address / pageSize;
+  uint64_t last = (address + size - 1) / pageSize;
+  uint64_t entries[64];
+  while (first <= last) {
+    uint64_t count = std::min<uint64_t>(last - first + 1, 64);
+    ssize_t bytes = count * sizeof(uint64_t);
+    if (pread(pagemap, entries, bytes, first * sizeof(uint64_t)) != bytes)
+      return true;
+    for (uint64_t i = 0; i < count; i++) {
+      if (entries[i] & SoftDirtyBit)
+        return true;
+    }
+    first += count;
+  }
+  return false;
+}
+
+#else
+
+DirtyPageTracker::DirtyPageTracker() : pagemap(-1), pageSize(0) {}
+
+DirtyPageTracker::~DirtyPageTracker() {}
+
+bool DirtyPageTracker::clear() { return false; }
+
+bool DirtyPageTracker::isDirty(uint64_t page, bool &dirty) { return false; }
+
+void DirtyPageTracker::reset() {}
+
+bool DirtyPageTracker::mayBeDirty(uint64_t address, size_t size) {
+  return true;
+}
+
+#endif
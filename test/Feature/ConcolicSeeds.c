@@ -0,0 +1,49 @@
+// RUN: %clang %s -emit-llvm %O0opt -c -g -o %t.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out %t.bc "initial"
+// RUN: test -f %t.klee-out/test000001.ktest
+// RUN: not test -f %t.klee-out/test000002.ktest
+
+// Following the seed alone only prints the seeded path.
+// RUN: rm -rf %t.klee-out-2
+// RUN: %klee --output-dir=%t.klee-out-2 --concolic-seeds --only-replay-seeds --seed-file %t.klee-out/test000001.ktest %t.bc > %t.only.log
+// RUN: FileCheck -check-prefix=CHECK-ONLY -input-file=%t.only.log %s
+// CHECK-ONLY: a==3
+// CHECK-ONLY-NOT: a!=3
+// CHECK-ONLY: b!=4
+// CHECK-ONLY-NOT: b==4
+
+// The directions no seed takes are forked off for the regular search.
+// RUN: rm -rf %t.klee-out-3
+// RUN: %klee --output-dir=%t.klee-out-3 --concolic-seeds --seed-file %t.klee-out/test000001.ktest %t.bc 2>&1 | FileCheck -check-prefix=CHECK-ALL %s
+// CHECK-ALL: KLEE: done: completed paths = 4
+
+#include "klee/klee.h"
+
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char **argv) {
+  int a, b;
+
+  klee_make_symbolic(&a, sizeof a, "a");
+  klee_make_symbolic(&b, sizeof b, "b");
+
+  if (argc == 2 && strcmp(argv[1], "initial") == 0) {
+    klee_assume(a == 3);
+    klee_assume(b == 5);
+    return 0;
+  }
+
+  if (a == 3)
+    printf("a==3\n");
+  else
+    printf("a!=3\n");
+
+  if (b == 4)
+    printf("b==4\n");
+  else
+    printf("b!=4\n");
+
+  return 0;
+}
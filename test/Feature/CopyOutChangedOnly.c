@@ -0,0 +1,41 @@
+// RUN: %clang %s -emit-llvm %O0opt -c -g -o %t.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --copy-out-changed-only %t.bc
+// RUN: grep "KLEE: done: explored paths = 1" %t.klee-out/info
+// RUN: not grep "ASSERTION FAIL" %t.klee-out/messages.txt
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --copy-out-changed-only=false %t.bc
+// RUN: grep "KLEE: done: explored paths = 1" %t.klee-out/info
+// RUN: not grep "ASSERTION FAIL" %t.klee-out/messages.txt
+
+// An object written by an external call and then written again by the
+// state is copied out before the next external call, while the objects
+// that did not change keep their native contents.
+
+#include <assert.h>
+#include <string.h>
+
+char buf[8] = "abc";
+char out[8];
+
+int main() {
+  /* the external call writes buf, which is copied back in */
+  strcpy(buf, "xyz");
+  assert(buf[0] == 'x' && buf[1] == 'y' && buf[2] == 'z');
+
+  /* the state restores the byte it had before the first call */
+  buf[0] = 'a';
+  strcpy(out, buf);
+  assert(out[0] == 'a' && out[1] == 'y' && out[2] == 'z' && out[3] == 0);
+
+  /* nothing changed since the last call */
+  strcpy(out, buf);
+  assert(out[0] == 'a' && out[1] == 'y' && out[2] == 'z' && out[3] == 0);
+
+  /* the state writes over what the external call wrote */
+  out[1] = 'b';
+  strcpy(buf, out);
+  assert(buf[0] == 'a' && buf[1] == 'b' && buf[2] == 'z' && buf[3] == 0);
+
+  return 0;
+}
@@ -0,0 +1,75 @@
+// RUN: %clang %s -emit-llvm %O0opt -c -g -o %t.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --optimize=false %t.bc 2>&1 | FileCheck %s
+// RUN: grep "KLEE: done: explored paths = 1" %t.klee-out/info
+// RUN: not grep "ASSERTION FAIL" %t.klee-out/messages.txt
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --optimize %t.bc 2>&1 | FileCheck %s
+// RUN: grep "KLEE: done: explored paths = 1" %t.klee-out/info
+// RUN: not grep "ASSERTION FAIL" %t.klee-out/messages.txt
+
+// Concrete registers are kept inline and only turned into expressions when
+// something needs one. The result of a concrete loop has to reach a
+// symbolic expression, an external call and the caller unchanged, with and
+// without the registers promoted out of memory.
+
+#include "klee/klee.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static int sum(int n) {
+  int s = 0;
+  for (int i = 0; i < n; i++)
+    s += i * 3 + 1;
+  return s;
+}
+
+static int64_t wide(int n) {
+  int64_t s = 1;
+  for (int i = 0; i < n; i++)
+    s = s * 5 - i;
+  return s;
+}
+
+static signed char narrow(int n) {
+  signed char c = 0;
+  for (int i = 0; i < n; i++)
+    c -= 7;
+  return c;
+}
+
+int main() {
+  // the bound is read from memory so the loops are not folded away
+  volatile int n = 10;
+
+  int s = sum(n);
+  int64_t w = wide(n);
+  signed char c = narrow(n);
+  assert(s == 145);
+  assert(w == 9155276);
+  assert(c == -70);
+
+  int x;
+  klee_make_symbolic(&x, sizeof(x), "x");
+  int y = x * s + s;
+  assert(y - x * s == 145);
+  int64_t z = (int64_t)x + w;
+  assert(z - x == 9155276);
+  int d = x - c;
+  assert(d - x == 70);
+
+  // called through a pointer so the optimizer keeps the call
+  int (*volatile ext)(int) = abs;
+  // CHECK: calling external: abs(145)
+  assert(ext(s) == 145);
+
+  klee_assume(x == 2);
+  assert(y == 435);
+  assert(z == 9155278);
+  assert(d == 72);
+
+  // CHECK: KLEE: done
+  return s - 145;
+}
@@ -3,6 +3,8 @@
 // RUN: %klee --output-dir=%t.klee-out  %t.bc 2> %t.log
 // RUN: klee-stats --print-more %t.klee-out > %t.stats
 // RUN: FileCheck -check-prefix=CHECK-STATS -input-file=%t.stats %s
+// RUN: klee-stats --print-relocation %t.klee-out > %t.reloc
+// RUN: FileCheck -check-prefix=CHECK-RELOC -input-file=%t.reloc %s
 #include "klee/klee.h"
 #include <stdlib.h>
 int main(){
@@ -17,3 +19,7 @@ int main(){
 // CHECK-STATS: | Path | Instrs| Time(s)| ICov(%)| BCov(%)| ICount| TSolver(%)|
 //Check there is a line with .klee-out dir, non zero instruction, less than 1 second execution time and 100 ICov.
 // CHECK-STATS: {{.*\.klee-out\|[ ]*[1-9]+\|[ ]*0\.([0-9]+)\|[ ]*100\.00}}
+
+// No relocation happens without symbolic addresses
+// CHECK-RELOC: {{.*Path.*Time.*Rebases.*RebasedKB.*Splits.*TRebase.*TUnfold.*RWCHits}}
+// CHECK-RELOC: {{.*\.klee-out\|[ ]*[0-9]+\.[0-9]+\|[ ]*0\|}}
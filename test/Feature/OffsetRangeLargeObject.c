@@ -0,0 +1,34 @@
+// RUN: %clang %s -emit-llvm %O0opt -c -g -o %t.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --use-offset-range-analysis %t.bc 2>&1 | FileCheck %s
+
+// The flushed window of a symbolic offset must cover every in bounds byte
+// it may point to, also past the first 64KB of an object.
+
+#include "klee/klee.h"
+
+#include <stdio.h>
+
+#define SIZE 66000
+
+char buf[SIZE];
+
+int main() {
+  unsigned i, j;
+  klee_make_symbolic(&i, sizeof(i), "i");
+  klee_make_symbolic(&j, sizeof(j), "j");
+  klee_assume(i < SIZE);
+  klee_assume(j < SIZE);
+
+  buf[65900] = 7;
+  // CHECK-DAG: read 7
+  if (buf[i] == 7)
+    printf("read 7\n");
+
+  buf[j] = 9;
+  // CHECK-DAG: wrote 9
+  if (buf[65901] == 9)
+    printf("wrote 9\n");
+
+  return 0;
+}
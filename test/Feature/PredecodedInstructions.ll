@@ -0,0 +1,204 @@
+; RUN: llvm-as %s -f -o %t1.bc
+; RUN: rm -rf %t.klee-out
+; RUN: %klee --output-dir=%t.klee-out --optimize=false --check-overshift=false %t1.bc > %t2
+; RUN: grep PASS %t2
+; RUN: grep "KLEE: done: explored paths = 1" %t.klee-out/info
+
+; The pre-decoded handlers compute instructions with concrete operands
+; themselves and leave the rest to the expression constructors, as the
+; generic path does. Every case is computed once on constant operands and
+; once on symbolic operands constrained to the same values, and both have
+; to give the expected result. The symbolic results are fully constrained,
+; so no branch forks.
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-unknown-linux-gnu"
+
+declare void @klee_make_symbolic(i8*, i64, i8*)
+declare void @klee_assume(i64)
+declare i32 @puts(i8*)
+
+@.name = private constant [2 x i8] c"x\00", align 1
+@.passstr = private constant [5 x i8] c"PASS\00", align 1
+@.failstr = private constant [5 x i8] c"FAIL\00", align 1
+
+; a symbolic value that can only be %v
+define i32 @sym(i32 %v) {
+entry:
+  %p = alloca i32, align 4
+  %b = bitcast i32* %p to i8*
+  call void @klee_make_symbolic(i8* %b, i64 4, i8* getelementptr inbounds ([2 x i8], [2 x i8]* @.name, i64 0, i64 0))
+  %x = load i32, i32* %p, align 4
+  %eq = icmp eq i32 %x, %v
+  %c = zext i1 %eq to i64
+  call void @klee_assume(i64 %c)
+  ret i32 %x
+}
+
+define i32 @main() {
+entry:
+  %s15 = call i32 @sym(i32 15)
+  %s32 = call i32 @sym(i32 32)
+  %s40 = call i32 @sym(i32 40)
+  %s8 = call i32 @sym(i32 8)
+  %sm1 = call i32 @sym(i32 -1)
+  %s1 = call i32 @sym(i32 1)
+  %s127 = call i32 @sym(i32 127)
+  %sm128 = call i32 @sym(i32 -128)
+  %sm32768 = call i32 @sym(i32 -32768)
+  %sf = call i32 @sym(i32 1065353216)
+  br label %shifts
+
+; shifts by at least the width
+shifts:
+  %c0 = shl i32 15, 32
+  %v0 = shl i32 %s15, %s32
+  %c1 = lshr i32 -1, 40
+  %v1 = lshr i32 %sm1, %s40
+  %c2 = ashr i32 8, 32
+  %v2 = ashr i32 %s8, %s32
+  %c3 = ashr i32 -8, 32
+  %w0 = or i32 %c0, %v0
+  %w1 = or i32 %c1, %v1
+  %w2 = or i32 %c2, %v2
+  %w3 = or i32 %w0, %w1
+  %w4 = or i32 %w3, %w2
+  %ok0 = icmp eq i32 %w4, 0
+  %ok1 = icmp eq i32 %c3, -1
+  %ok2 = and i1 %ok0, %ok1
+  br i1 %ok2, label %bools, label %fail
+
+; arithmetic on i1
+bools:
+  %sb1 = trunc i32 %s1 to i1
+  %c10 = add i1 1, 1
+  %v10 = add i1 %sb1, %sb1
+  %c11 = sub i1 0, 1
+  %v11 = sub i1 false, %sb1
+  %c12 = mul i1 1, 1
+  %v12 = mul i1 %sb1, %sb1
+  %c13 = shl i1 1, 1
+  %v13 = shl i1 %sb1, %sb1
+  %c14 = ashr i1 1, 1
+  %v14 = ashr i1 %sb1, %sb1
+  %c15 = icmp slt i1 1, 0
+  %v15 = icmp slt i1 %sb1, false
+  %z0 = or i1 %c10, %v10
+  %z1 = or i1 %c13, %v13
+  %z2 = or i1 %z0, %z1
+  %n0 = and i1 %c11, %v11
+  %n1 = and i1 %c12, %v12
+  %n2 = and i1 %c14, %v14
+  %n3 = and i1 %c15, %v15
+  %n4 = and i1 %n0, %n1
+  %n5 = and i1 %n2, %n3
+  %n6 = and i1 %n4, %n5
+  %nz = xor i1 %z2, true
+  %ok10 = and i1 %n6, %nz
+  br i1 %ok10, label %signed, label %fail
+
+; signed compares and sign extension from narrow types
+signed:
+  %sm128.8 = trunc i32 %sm128 to i8
+  %s127.8 = trunc i32 %s127 to i8
+  %sm1.16 = trunc i32 %sm1 to i16
+  %sm32768.16 = trunc i32 %sm32768 to i16
+  %c20 = icmp slt i8 -128, 127
+  %v20 = icmp slt i8 %sm128.8, %s127.8
+  %c21 = icmp sgt i16 -1, 0
+  %v21 = icmp sgt i16 %sm1.16, 0
+  %c22 = icmp sge i8 127, -128
+  %v22 = icmp sge i8 %s127.8, %sm128.8
+  %c23 = icmp ule i8 127, -128
+  %v23 = icmp ule i8 %s127.8, %sm128.8
+  %c24 = sext i8 -128 to i64
+  %v24 = sext i8 %sm128.8 to i64
+  %c25 = sext i16 -32768 to i32
+  %v25 = sext i16 %sm32768.16 to i32
+  %c26 = sext i8 127 to i32
+  %v26 = sext i8 %s127.8 to i32
+  %t0 = and i1 %c20, %v20
+  %t1 = or i1 %c21, %v21
+  %t2 = and i1 %c22, %v22
+  %t3 = and i1 %c23, %v23
+  %e0 = icmp eq i64 %c24, -128
+  %e1 = icmp eq i64 %v24, -128
+  %e2 = icmp eq i32 %c25, -32768
+  %e3 = icmp eq i32 %v25, -32768
+  %e4 = icmp eq i32 %c26, 127
+  %e5 = icmp eq i32 %v26, 127
+  %u0 = xor i1 %t1, true
+  %u1 = and i1 %t0, %u0
+  %u2 = and i1 %t2, %t3
+  %u3 = and i1 %e0, %e1
+  %u4 = and i1 %e2, %e3
+  %u5 = and i1 %e4, %e5
+  %u6 = and i1 %u1, %u2
+  %u7 = and i1 %u3, %u4
+  %u8 = and i1 %u6, %u7
+  %ok20 = and i1 %u8, %u5
+  br i1 %ok20, label %phis, label %fail
+
+; PHIs reached through unconditional branches
+phis:
+  br i1 %ok20, label %left, label %right
+
+left:
+  br label %join
+
+right:
+  br label %join
+
+join:
+  %p0 = phi i32 [ 1, %left ], [ 2, %right ]
+  %p1 = phi i32 [ %s127, %left ], [ %s8, %right ]
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %join ], [ %i.next, %loop ]
+  %acc = phi i32 [ %s1, %join ], [ %acc.next, %loop ]
+  %acc.next = add i32 %acc, %i
+  %i.next = add i32 %i, 1
+  %more = icmp ult i32 %i.next, 4
+  br i1 %more, label %loop, label %after
+
+after:
+  %e30 = icmp eq i32 %p0, 1
+  %e31 = icmp eq i32 %p1, 127
+  %e32 = icmp eq i32 %acc.next, 7
+  %e33 = icmp eq i32 %i.next, 4
+  %u30 = and i1 %e30, %e31
+  %u31 = and i1 %e32, %e33
+  %ok30 = and i1 %u30, %u31
+  br i1 %ok30, label %casts, label %fail
+
+; bitcasts of types other than integers
+casts:
+  %f0 = bitcast i32 1065353216 to float
+  %f1 = fadd float %f0, %f0
+  %c40 = bitcast float %f1 to i32
+  %f2 = bitcast i32 %sf to float
+  %v40 = bitcast float %f2 to i32
+  %d0 = bitcast i64 4607182418800017408 to double
+  %c41 = bitcast double %d0 to i64
+  %buf = alloca i32, align 4
+  store i32 %s127, i32* %buf, align 4
+  %bytes = bitcast i32* %buf to i8*
+  %b0 = load i8, i8* %bytes, align 4
+  %e40 = icmp eq i32 %c40, 1073741824
+  %e41 = icmp eq i32 %v40, 1065353216
+  %e42 = icmp eq i64 %c41, 4607182418800017408
+  %e43 = icmp eq i8 %b0, 127
+  %u40 = and i1 %e40, %e41
+  %u41 = and i1 %e42, %e43
+  %ok40 = and i1 %u40, %u41
+  br i1 %ok40, label %pass, label %fail
+
+pass:
+  %0 = call i32 @puts(i8* getelementptr inbounds ([5 x i8], [5 x i8]* @.passstr, i64 0, i64 0)) nounwind
+  ret i32 0
+
+fail:
+  %1 = call i32 @puts(i8* getelementptr inbounds ([5 x i8], [5 x i8]* @.failstr, i64 0, i64 0)) nounwind
+  ret i32 1
+}
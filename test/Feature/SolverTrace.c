@@ -0,0 +1,21 @@
+// RUN: %clang %s -emit-llvm -g %O0opt -c -o %t.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --solver-trace %t.bc 2> %t.log
+// RUN: klee-solver-trace --by layer %t.klee-out > %t.layers
+// RUN: FileCheck -check-prefix=CHECK-LAYER -input-file=%t.layers %s
+// RUN: klee-solver-trace --by kind %t.klee-out > %t.kinds
+// RUN: FileCheck -check-prefix=CHECK-KIND -input-file=%t.kinds %s
+#include "klee/klee.h"
+
+int main() {
+  int a;
+  klee_make_symbolic(&a, sizeof(a), "a");
+  if (a > 10)
+    return 1;
+  return 0;
+}
+// CHECK-LAYER: Layer | Calls
+// CHECK-LAYER: core |
+// CHECK-LAYER: queries, {{[0-9.]+}}s in the solver chain
+// CHECK-KIND: evaluate |
+// CHECK-KIND: getInitialValues |
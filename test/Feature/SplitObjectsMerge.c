@@ -0,0 +1,55 @@
+// RUN: %clang %s -emit-llvm %O0opt -c -g -o %t.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --use-sym-addr --split-objects --merge-split-interval=100 %t.bc 2>&1 | FileCheck %s
+// RUN: not grep "ASSERTION FAIL" %t.klee-out/messages.txt
+
+// A split object is merged back once no symbolic pointer in a register may
+// point into it. The merged object keeps its contents and address, the
+// constraints over its contents still hold, and it is not merged again
+// after a second split.
+
+#include "klee/klee.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define SIZE 1024
+
+/* the symbolic pointer dies with the frame, and after the split it
+   resolves to the first part only, so the path does not fork */
+char read_at(char *buf) {
+  unsigned i;
+  klee_make_symbolic(&i, sizeof(i), "i");
+  klee_assume(i < 64);
+  klee_assume(buf[i] == 3);
+  return buf[i];
+}
+
+void spin(void) {
+  volatile int n = 0;
+  for (int k = 0; k < 1000; k++)
+    n++;
+}
+
+int main() {
+  char *buf = malloc(SIZE);
+  for (int k = 0; k < SIZE; k++)
+    buf[k] = k % 7;
+
+  // CHECK: splitting object {{[0-9]+}} (size = 1024)
+  assert(read_at(buf) == 3);
+  spin();
+  // CHECK: merging {{[0-9]+}} split objects to {{[0-9]+}} (size = 1024)
+  assert(buf[3] == 3 && buf[SIZE - 1] == (SIZE - 1) % 7);
+
+  // CHECK: splitting object {{[0-9]+}} (size = 1024)
+  assert(read_at(buf) == 3);
+  spin();
+  // CHECK-NOT: merging
+  // CHECK-NOT: memory error
+  // CHECK: KLEE: done
+  assert(buf[3] == 3);
+
+  free(buf);
+  return 0;
+}
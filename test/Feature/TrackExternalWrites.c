@@ -0,0 +1,41 @@
+// REQUIRES: linux
+// RUN: %clang %s -emit-llvm %O0opt -c -g -o %t.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --track-external-writes %t.bc
+// RUN: grep "KLEE: done: explored paths = 1" %t.klee-out/info
+// RUN: not grep "ASSERTION FAIL" %t.klee-out/messages.txt
+
+// With --track-external-writes only the objects on pages written by an
+// external call are copied back in. The objects the call wrote must be
+// seen by the state, and the state's later writes by the next call.
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+char buf[8] = "abc";
+char out[8];
+
+int main() {
+  /* a heap object, on other pages than the globals */
+  char *heap = malloc(4096);
+  heap[0] = 'h';
+  heap[1] = 0;
+
+  /* the external call writes buf, which is copied back in */
+  strcpy(buf, "xyz");
+  assert(buf[0] == 'x' && buf[1] == 'y' && buf[2] == 'z');
+  assert(heap[0] == 'h');
+
+  /* the state writes buf again before the next call */
+  buf[0] = 'a';
+  strcpy(out, buf);
+  assert(out[0] == 'a' && out[1] == 'y' && out[2] == 'z' && out[3] == 0);
+
+  /* a write on a page the previous call did not touch */
+  strcpy(heap, out);
+  assert(heap[0] == 'a' && heap[1] == 'y' && heap[2] == 'z' && heap[3] == 0);
+
+  free(heap);
+  return 0;
+}
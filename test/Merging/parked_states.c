@@ -0,0 +1,68 @@
+// RUN: %clang -emit-llvm -g -c -o %t.bc %s
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --use-merge --search=bfs %t.bc 2>&1 | FileCheck %s
+// RUN: not grep "ASSERTION FAIL" %t.klee-out/messages.txt
+// RUN: klee-stats --to-csv %t.klee-out > %t.stats.csv
+// RUN: FileCheck -check-prefix=CHECK-STATS -input-file=%t.stats.csv %s
+// RUN: tail -n 1 %t.stats.csv | FileCheck -check-prefix=CHECK-LAST %s
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --use-merge --search=dfs %t.bc 2>&1 | FileCheck %s
+// RUN: not grep "ASSERTION FAIL" %t.klee-out/messages.txt
+// RUN: klee-stats --to-csv %t.klee-out > %t.stats.csv
+// RUN: tail -n 1 %t.stats.csv | FileCheck -check-prefix=CHECK-LAST %s
+
+// States waiting at a klee_close_merge are parked. In the first region the
+// four paths merge into the first one that arrives, which is parked once
+// and taken out again for every merge. In the second region the paths
+// allocate different objects and cannot merge, so all three wait. The
+// state that continues from the first region was parked before and is not
+// counted again, the other two are new, which gives three parked states.
+// All of them are released at the end, so no parked bytes are left.
+
+// Without the merge the first region would leave four states and twelve
+// tests, a failing assert would add an error test.
+// CHECK: KLEE: done: generated tests = 3{{$}}
+
+// CHECK-STATS: ParkedStates,ParkedBytes,ParkedBytesSaved
+// CHECK-LAST: ,3,0,0
+
+#include <klee/klee.h>
+
+#include <assert.h>
+#include <stdlib.h>
+
+int main(int argc, char **args) {
+  int x, y;
+  int foo = 0;
+
+  klee_make_symbolic(&x, sizeof(x), "x");
+  klee_make_symbolic(&y, sizeof(y), "y");
+
+  klee_open_merge();
+  if (x == 1)
+    foo = 5;
+  else if (x == 2)
+    foo = 6;
+  else if (x == 3)
+    foo = 7;
+  else
+    foo = 8;
+  klee_close_merge();
+
+  // a single state carries every value, the check does not fork
+  assert(foo == 5 * (x == 1) + 6 * (x == 2) + 7 * (x == 3) +
+                    8 * ((x != 1) & (x != 2) & (x != 3)));
+
+  char *p;
+  klee_open_merge();
+  if (y == 0)
+    p = malloc(1);
+  else if (y == 1)
+    p = malloc(2);
+  else
+    p = malloc(3);
+  klee_close_merge();
+
+  free(p);
+  return foo;
+}
@@ -264,4 +264,66 @@ TEST(ExprTest, ReadExprFoldingSymbolicIndexUpdate) {
     EXPECT_EQ(Expr::Read, read.get()->getKind());
   }
 }
+
+TEST(ExprTest, ReadExprFoldingWordUpdate) {
+  ArrayCache ac;
+  const Array *array = ac.CreateArray("arr", 16);
+
+  // One update writes the four bytes of a symbolic value at a symbolic index
+  UpdateList ul(array, 0);
+  const Array *indexArray = ac.CreateArray("idx", 4);
+  const Array *valueArray = ac.CreateArray("val", 4);
+  ref<Expr> updateIndex = ReadExpr::createTempRead(indexArray, Expr::Int32);
+  ref<Expr> updateValue = ReadExpr::createTempRead(valueArray, Expr::Int32);
+  ul.extend(updateIndex, updateValue);
+  EXPECT_EQ(1u, ul.getSize());
+  EXPECT_EQ(4u, ul.head->getNumElements(array->getRange()));
+
+  // Reads of the written bytes fold to the bytes of the value
+  ref<Expr> bytes[4];
+  for (unsigned i = 0; i < 4; ++i) {
+    bytes[3 - i] = ReadExpr::create(
+        ul, AddExpr::create(ConstantExpr::create(i, Expr::Int32),
+                            updateIndex));
+    EXPECT_EQ(ExtractExpr::create(updateValue, 8 * i, Expr::Int8),
+              bytes[3 - i]);
+  }
+  // and so does the whole word
+  EXPECT_EQ(updateValue, ConcatExpr::createN(4, bytes));
+
+  // Reads past the written bytes or at unrelated indices are not folded
+  ref<Expr> read = ReadExpr::create(
+      ul, AddExpr::create(ConstantExpr::create(4, Expr::Int32), updateIndex));
+  EXPECT_EQ(Expr::Read, read.get()->getKind());
+  read = ReadExpr::create(ul, ConstantExpr::create(0, Expr::Int32));
+  EXPECT_EQ(Expr::Read, read.get()->getKind());
+}
+
+struct FreedArrays : public ArrayFreeListener {
+  std::vector<const Array *> freed;
+  void arrayFreed(const Array *array) override { freed.push_back(array); }
+};
+
+TEST(ExprTest, ReleasedArrayFreedWhenUnreferenced) {
+  std::vector<ref<ConstantExpr> > Contents(4);
+  for (unsigned i = 0; i < 4; ++i)
+    Contents[i] = ConstantExpr::create(i, Expr::Int8);
+  ArrayCache ac;
+  FreedArrays listener;
+  const Array *array =
+      ac.CreateArray("arr", 4, &Contents[0], &Contents[0] + 4);
+
+  ref<Expr> read = ReadExpr::create(UpdateList(array, 0),
+                                    ReadExpr::createTempRead(
+                                        ac.CreateArray("idx", 4), 32));
+  {
+    ArrayHolder holder(array);
+    ac.release(array);
+    read = nullptr;
+    // still held
+    EXPECT_TRUE(listener.freed.empty());
+  }
+  ASSERT_EQ(1u, listener.freed.size());
+  EXPECT_EQ(array, listener.freed[0]);
+}
 }
@@ -166,4 +166,49 @@ TEST(SolverTest, Evaluation) {
   delete solver;
 }
 
+TEST(SolverTest, WordUpdates) {
+  Solver *solver = klee::createCoreSolver(CoreSolverToUse);
+
+  // One update writes the four bytes of a symbolic value at a symbolic index,
+  // and is read at another symbolic index
+  const Array *array = ac.CreateArray("mem", 16);
+  ref<Expr> index =
+      Expr::createTempRead(ac.CreateArray("index", 4), Expr::Int32);
+  ref<Expr> value =
+      Expr::createTempRead(ac.CreateArray("value", 4), Expr::Int32);
+  ref<Expr> readIndex =
+      Expr::createTempRead(ac.CreateArray("readIndex", 4), Expr::Int32);
+  UpdateList ul(array, 0);
+  ul.extend(index, value);
+  ref<Expr> read = ReadExpr::create(ul, readIndex);
+
+  for (unsigned i = 0; i < 4; ++i) {
+    // A read of a written byte must see the byte of the value
+    ConstraintManager constraints;
+    constraints.addConstraint(EqExpr::create(
+        readIndex,
+        AddExpr::create(ConstantExpr::create(i, Expr::Int32), index)));
+    bool result;
+    ASSERT_TRUE(solver->mustBeTrue(
+        Query(constraints,
+              EqExpr::create(read, ExtractExpr::create(value, 8 * i,
+                                                       Expr::Int8))),
+        result));
+    EXPECT_TRUE(result);
+  }
+
+  // A read past the written bytes does not
+  ConstraintManager constraints;
+  constraints.addConstraint(EqExpr::create(
+      readIndex, AddExpr::create(ConstantExpr::create(4, Expr::Int32), index)));
+  bool result;
+  ASSERT_TRUE(solver->mustBeTrue(
+      Query(constraints,
+            EqExpr::create(read, ExtractExpr::create(value, 24, Expr::Int8))),
+      result));
+  EXPECT_FALSE(result);
+
+  delete solver;
+}
+
 }